@@ -2,10 +2,131 @@
  * SPDX-License-Identifier: MIT
  */
 
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_WIN32)
+#define ATTEST_POSIX 1
+#endif
+
+// Strict ISO modes such as -std=c99 hide POSIX, so Attest asks for it
+// unless the program picked its own feature macros. The GNU modes
+// expose POSIX already, and a define there would hide their extensions.
+#if defined(ATTEST_POSIX) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) \
+    && !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE) && !defined(_DEFAULT_SOURCE)
+#if defined(ATTEST_PERF_COUNTERS) && defined(__linux__)
+// syscall() is outside of POSIX.
+#define _DEFAULT_SOURCE 1
+#endif
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#if defined(ATTEST_POSIX) && defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE < 200809L
+#error "Attest uses POSIX.1-2008 APIs: define _POSIX_C_SOURCE to 200809L or higher"
+#endif
+
+#include <limits.h>
+#include <setjmp.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifdef ATTEST_POSIX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if !defined(ATTEST_NO_THREADS) && (defined(__GNUC__) || defined(__clang__))
+#define ATTEST_THREADS 1
+#include <pthread.h>
+#endif
+#endif
+
+#ifdef ATTEST_TRACK_ALLOCS
+#include <malloc.h>
+#if !defined(__GLIBC__)
+#error "ATTEST_TRACK_ALLOCS replaces malloc the way glibc supports and needs glibc"
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#error "ATTEST_TRACK_ALLOCS can not be combined with a sanitizer that replaces malloc"
+#endif
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+#endif
+
+#ifdef ATTEST_PERF_COUNTERS
+#if !defined(__linux__)
+#error "ATTEST_PERF_COUNTERS reads counters with perf_event_open and needs Linux"
+#endif
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#if defined(__GLIBC__) && !defined(_DEFAULT_SOURCE)
+#error "ATTEST_PERF_COUNTERS calls syscall(), which needs _DEFAULT_SOURCE next to your own feature macros"
+#endif
+#endif
+
+// Array expectations compare with the widest vector unit the build
+// targets and fall back to scalar loops.
+#if !defined(ATTEST_NO_SIMD) && defined(__AVX2__)
+#define ATTEST_SIMD_AVX2 1
+#include <immintrin.h>
+#elif !defined(ATTEST_NO_SIMD) && defined(__SSE2__)
+#define ATTEST_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif !defined(ATTEST_NO_SIMD) && defined(__ARM_NEON)
+#define ATTEST_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef ATTEST_IMPACT
+#if !defined(__linux__)
+#error "ATTEST_IMPACT resolves the functions of /proc/self/exe and needs Linux"
+#endif
+// Start and end of the executable's code, both defined by the linker.
+extern char __executable_start[];
+extern char etext[];
+#endif
+
+#ifdef ATTEST_WATCH
+#if !defined(ATTEST_POSIX)
+#error "ATTEST_WATCH loads the tests with dlopen and needs a POSIX platform"
+#endif
+#include <dlfcn.h>
+#include <sys/stat.h>
+#endif
+
+// State of the running test lives in thread local storage while cases
+// may run on several threads.
+#ifdef ATTEST_THREADS
+#define ATTEST_THREAD_LOCAL __thread
+#else
+#define ATTEST_THREAD_LOCAL
+#endif
+
+#ifdef ATTEST_TRACK_ALLOCS
+#define ATTEST_PAUSE_ALLOCS() (attest_alloc_paused++)
+#define ATTEST_RESUME_ALLOCS() (attest_alloc_paused--)
+#else
+#define ATTEST_PAUSE_ALLOCS() ((void)0)
+#define ATTEST_RESUME_ALLOCS() ((void)0)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ATTEST_LIKELY(x) __builtin_expect(!!(x), 1)
+#define ATTEST_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define ATTEST_COLD __attribute__((cold, noinline))
+#else
+#define ATTEST_LIKELY(x) (x)
+#define ATTEST_UNLIKELY(x) (x)
+#define ATTEST_COLD
+#endif
 
 /**************************
  * OPTIONS
@@ -29,6 +150,12 @@
 #define ATTEST_VALUE_BUF 128
 #endif
 
+// Bytes around the first difference a failed array or memory
+// expectation shows
+#ifndef ATTEST_DIFF_WINDOW
+#define ATTEST_DIFF_WINDOW 16
+#endif
+
 // Max amount of attempts
 #ifndef ATTEST_MAX_TEST_ATTEMPTS
 #define ATTEST_MAX_TEST_ATTEMPTS 32
@@ -44,11 +171,117 @@
 #define ATTEST_MAX_TAGS 8
 #endif
 
+// Max amount of entries listed by `--slowest`
+#ifndef ATTEST_MAX_SLOWEST
+#define ATTEST_MAX_SLOWEST 64
+#endif
+
+// Max amount of threads for a test with `.parallel_cases`
+#ifndef ATTEST_MAX_CASE_THREADS
+#define ATTEST_MAX_CASE_THREADS 64
+#endif
+
+// Max amount of threads started by one test body that record
+// expectations
+#ifndef ATTEST_MAX_TEST_THREADS
+#define ATTEST_MAX_TEST_THREADS 16
+#endif
+
+// Max amount of case scoped fixtures a single case uses
+#ifndef ATTEST_MAX_FIXTURES
+#define ATTEST_MAX_FIXTURES 16
+#endif
+
+// Amount of timed samples a benchmark takes
+#ifndef ATTEST_BENCH_SAMPLES
+#define ATTEST_BENCH_SAMPLES 31
+#endif
+
+// Time a single benchmark sample aims for
+#ifndef ATTEST_BENCH_SAMPLE_MS
+#define ATTEST_BENCH_SAMPLE_MS 5
+#endif
+
+// Min time a benchmark runs before it takes samples
+#ifndef ATTEST_BENCH_WARMUP_MS
+#define ATTEST_BENCH_WARMUP_MS 50
+#endif
+
+#if ATTEST_BENCH_SAMPLES < 1
+#error "ATTEST_BENCH_SAMPLES needs to be at least 1"
+#endif
+
+// Default amount of inputs a `PROPERTY_TEST` tries
+#ifndef ATTEST_PROPERTY_ITERATIONS
+#define ATTEST_PROPERTY_ITERATIONS 1000
+#endif
+
+// Max amount of random choices one run of a property records. Later
+// draws of that run get the smallest value.
+#ifndef ATTEST_PROPERTY_MAX_CHOICES
+#define ATTEST_PROPERTY_MAX_CHOICES 4096
+#endif
+
+// Max amount of replays spent shrinking a counterexample
+#ifndef ATTEST_PROPERTY_MAX_SHRINKS
+#define ATTEST_PROPERTY_MAX_SHRINKS 10000
+#endif
+
+// Slowdown in percent `--baseline` allows before a test fails
+#ifndef ATTEST_BASELINE_TOLERANCE
+#define ATTEST_BASELINE_TOLERANCE 20
+#endif
+
+// Tests and cases faster than this in the baseline are not compared
+#ifndef ATTEST_BASELINE_MIN_US
+#define ATTEST_BASELINE_MIN_US 1000
+#endif
+
+// Max amount of functions `--impact-map` records for one test. A test
+// that enters more runs on every change.
+#ifndef ATTEST_IMPACT_MAX_FUNCTIONS
+#define ATTEST_IMPACT_MAX_FUNCTIONS 4096
+#endif
+
+// Amount of recent runs `--history` keeps for each test
+#ifndef ATTEST_HISTORY_RUNS
+#define ATTEST_HISTORY_RUNS 20
+#endif
+
+// Time between two looks at the library of `--watch`
+#ifndef ATTEST_WATCH_POLL_MS
+#define ATTEST_WATCH_POLL_MS 50
+#endif
+
+// Program that looks up the function and source of an address
+#ifndef ATTEST_ADDR2LINE
+#define ATTEST_ADDR2LINE "addr2line"
+#endif
+
+// Max amount of worker processes for `--jobs`
+#ifndef ATTEST_MAX_JOBS
+#define ATTEST_MAX_JOBS 256
+#endif
+
+// Size of the buffer reporter output collects in before it is written
+#ifndef ATTEST_OUTPUT_BUF
+#define ATTEST_OUTPUT_BUF 16384
+#endif
+
+// File descriptor reports are written to
+#ifndef ATTEST_OUTPUT_FD
+#define ATTEST_OUTPUT_FD 1
+#endif
+
 // Max amount of tags
 #ifndef ATTEST_MAX_TAG_SIZE
 #define ATTEST_MAX_TAG_SIZE 21
 #endif
 
+#if ATTEST_MAX_TAGS > 64
+#error "ATTEST_MAX_TAGS can not be higher than 64"
+#endif
+
 #ifdef ATTEST_NO_COLOR
 #define RED ""
 #define NORMAL ""
@@ -108,8 +341,44 @@ typedef enum {
     MISSING_EXPECTATION,
     PASSED,
     FAILED,
+    TIMED_OUT,
+    CRASHED,
 } Status;
 
+// Hardware counters of the thread that ran the last attempt of a test
+// with `ATTEST_PERF_COUNTERS`. Counters that can't be read stay at -1.
+typedef struct
+{
+    long long instructions;
+    long long cycles;
+    long long cache_misses;
+    long long branch_misses;
+} PerfStats;
+
+// Result of a `BENCH`. Times are in nanoseconds per iteration.
+typedef struct
+{
+    long long iterations;
+    int samples;
+    double mean_ns;
+    double median_ns;
+    double p99_ns;
+    double stddev_ns;
+    // Counted over all timed samples, not per iteration.
+    PerfStats perf;
+} BenchStats;
+
+// Allocations of the last attempt of a test with `ATTEST_TRACK_ALLOCS`.
+// Live and peak bytes use the usable size the allocator reports.
+typedef struct
+{
+    long long allocs;
+    long long frees;
+    long long bytes;
+    long long peak_bytes;
+    long long leaked_bytes;
+} AllocStats;
+
 typedef struct TestConfig {
     char* filename;
     int line;
@@ -128,62 +397,423 @@ typedef struct TestConfig {
     void (*param_init)(void);
     void (*param_test_runner)(void);
     void (*param_test)(struct TestConfig*);
+    // Cases come from a provider instead of a static list.
+    bool streams_cases;
+    void (*benchmark)(TestContext*);
+    void (*property)(void);
+    // Inputs a property tries, and the seed it draws them from when
+    // not derived from `--seed`.
+    int iterations;
+    unsigned long long seed;
     struct TestConfig* next;
     int attempt_count;
+    // Slot of the case in `parameterize_instance_results`.
     int param_index;
+    // Position of the case in the values of the test. Differs from
+    // `param_index` when `--shard-cases` leaves cases out.
+    int case_index;
+    int timeout_ms;
+    bool abort_on_failure;
+    bool parallel_cases;
+    bool check_leaks;
+    bool isolated;
     char* tags[ATTEST_MAX_TAGS + 1];
+    // Bit `i` is set when the test has the i-th tag passed with `--tag`.
+    unsigned long long tag_mask;
     Status status;
+    long long wall_ns;
+    long long cpu_ns;
+    BenchStats bench_stats;
+    AllocStats alloc_stats;
+    PerfStats perf_stats;
 } TestConfig;
 
+typedef enum {
+    ATTEST_SCOPE_PROCESS,
+    ATTEST_SCOPE_SUITE,
+    ATTEST_SCOPE_TEST,
+    ATTEST_SCOPE_CASE,
+} FixtureScope;
+
+// A value `FIXTURE` builds on first use and keeps for its scope. All
+// threads share it, except in the case scope where each case has its own.
+typedef struct AttestFixture {
+    const char* name;
+    FixtureScope scope;
+    void* (*setup)(void);
+    void (*teardown)(void*);
+    struct AttestFixture* next;
+    // Next fixture in `attest_built_fixtures`.
+    struct AttestFixture* built_below;
+    void* value;
+    bool built;
+} AttestFixture;
+
+typedef enum {
+    ATTEST_VALUE_INT,
+    ATTEST_VALUE_UINT,
+    ATTEST_VALUE_CHAR,
+    ATTEST_VALUE_PTR,
+    ATTEST_VALUE_STRING,
+    ATTEST_VALUE_NS,
+    ATTEST_VALUE_BYTES,
+    ATTEST_VALUE_FLOATS,
+} ValueKind;
+
+// Raw operand of a failed expectation. It is only turned into text
+// when a reporter displays the failure.
+typedef struct
+{
+    ValueKind kind;
+    const char* label;
+    union {
+        long long as_int;
+        unsigned long long as_uint;
+        const void* as_ptr;
+        const char* as_string;
+    } raw;
+#ifndef ATTEST_BORROW_STRINGS
+    // Strings are copied because they may not outlive the test.
+    char retained[ATTEST_VALUE_BUF];
+    bool is_truncated;
+#endif
+    // Copy of the bytes or elements around the first difference. The
+    // mark is the offset of the differing byte or element.
+    unsigned char window[ATTEST_DIFF_WINDOW];
+    int window_size;
+    int window_mark;
+    int element_size;
+    bool has_before;
+    bool has_after;
+} CapturedValue;
+
 typedef struct
 {
-    char* test_name;
     char* filename;
     int line;
+    const char* verification;
     bool has_msg;
     char msg[ATTEST_VALUE_BUF];
+    bool has_expected_value;
+    CapturedValue actual;
+    CapturedValue expected;
+    const char* reason;
+    // Element of the arrays where they first differ
+    bool has_index;
+    size_t index;
+} FailureInfo;
+
+// Text of a failure, rendered from a `FailureInfo` by reporters.
+typedef struct
+{
     char verification_text[ATTEST_VALUE_BUF];
     char actual_label[ATTEST_VALUE_BUF];
     char actual_value[ATTEST_VALUE_BUF];
-    bool has_expected_value;
     char expected_label[ATTEST_VALUE_BUF];
     char expected_value[ATTEST_VALUE_BUF];
-    char reason[ATTEST_VALUE_BUF];
-} FailureInfo;
+} FailureText;
 
 typedef struct
 {
+#ifdef ATTEST_GROWABLE_STORAGE
+    FailureInfo* failures;
+    size_t capacity;
+#else
     FailureInfo failures[ATTEST_MAX_FAILURES];
+#endif
     size_t count;
 } FailureList;
 
+#ifdef ATTEST_THREADS
+// Expectations of one thread the test body started. Only that thread
+// appends, so the list needs no lock. Pushing the buffer onto the shared
+// list is a compare and swap.
+typedef struct AttestThreadFailures {
+    struct AttestThreadFailures* next;
+    FailureList list;
+    bool passed;
+} AttestThreadFailures;
+#endif
+
 // TODO: standarize instance noun to case
 typedef struct
 {
     char* case_name;
     Status status;
     int failure_count;
+#ifdef ATTEST_GROWABLE_STORAGE
+    FailureInfo* failures;
+    size_t failure_capacity;
+#else
     FailureInfo failures[ATTEST_MAX_PARAMERTERIZE_RESULTS];
+#endif
     bool has_status;
+    // Copy of the name of a failed streamed case, since the provider
+    // reuses its buffer for the next case.
+    char kept_name[ATTEST_CASE_NAME_SIZE];
+    int case_index;
+    long long wall_ns;
+    long long cpu_ns;
+    PerfStats perf_stats;
 } InstanceResult;
 
+typedef struct
+{
+    long long wall_ns;
+    long long cpu_ns;
+} AttestClock;
+
+// Runs the case at `case_index` of a parameterized test and stores its
+// result in `slot`. Generated by `PARAM_TEST` and `PARAM_TEST_CTX`.
+typedef void (*AttestCaseRunner)(int slot, int case_index);
+
+typedef struct
+{
+    char* test_title;
+    // Copied, since names of streamed cases live in a reused buffer.
+    char case_name[ATTEST_CASE_NAME_SIZE];
+    int case_index;
+    char* filename;
+    int line;
+    long long wall_ns;
+    long long cpu_ns;
+} TimingRecord;
+
 typedef struct
 {
     void* all;
 } GlobalContext;
 
+typedef struct
+{
+    const char* key;
+    double ns;
+} BaselineEntry;
+
+// Test of the impact map and the lines listing its sources, each
+// starting with a tab.
+typedef struct
+{
+    const char* title;
+    const char* sources;
+} ImpactEntry;
+
+// Test of `--history` and its recent runs, oldest first.
+typedef struct
+{
+    const char* title;
+    const char* runs;
+    bool written;
+} HistoryEntry;
+
+typedef struct
+{
+    const char* title;
+    int flaky_runs;
+    int run_count;
+} FlakyRecord;
+
+#ifdef ATTEST_IMPACT
+typedef struct
+{
+    size_t offset;
+    const char* function;
+    const char* source;
+} ImpactFunction;
+#endif
+
+#ifdef ATTEST_WATCH
+// Stamp of the library `--watch` loads. Rebuilding it moves at least
+// one of them.
+typedef struct
+{
+    time_t modified;
+    off_t size;
+    ino_t inode;
+} WatchStamp;
+#endif
+
+#ifdef ATTEST_TRACK_ALLOCS
+typedef struct
+{
+    long long allocs;
+    long long frees;
+    long long bytes;
+    long long live_bytes;
+} AllocMark;
+
+// Block of `EXPECT_NO_ALLOC` or `EXPECT_MAX_ALLOCS`.
+typedef struct
+{
+    char* filename;
+    int line;
+    const char* verification;
+    const char* reason;
+    const char* limit_label;
+    long long limit;
+    long long start_allocs;
+    bool active;
+} AllocScope;
+#endif
+
+typedef struct
+{
+    AttestFixture* fixture;
+    void* value;
+} FixtureValue;
+
+// Random choices of the running property. Exploring records what the
+// generators drew. Replaying feeds recorded choices back, which is how
+// the shrinker tries smaller inputs.
+typedef struct
+{
+    unsigned long long rng;
+    int count;
+    int position;
+    bool replaying;
+    // Generators describe their values while the shrunk input replays.
+    bool describing;
+    char inputs[ATTEST_VALUE_BUF];
+    size_t inputs_length;
+} PropertyState;
+
+#ifdef ATTEST_PERF_COUNTERS
+// Block of `EXPECT_MAX_INSTRUCTIONS`.
+typedef struct
+{
+    char* filename;
+    int line;
+    const char* limit_label;
+    long long limit;
+    long long start_instructions;
+    bool active;
+} PerfScope;
+#endif
+
+typedef enum {
+    ATTEST_FORMAT_TEXT,
+    ATTEST_FORMAT_JUNIT,
+    ATTEST_FORMAT_JSONL,
+    ATTEST_FORMAT_TAP,
+} ReportFormat;
+
+typedef enum {
+    ATTEST_ORDER_DECLARED,
+    ATTEST_ORDER_FAILED_FIRST,
+} TestOrder;
+
 typedef struct
 {
     void* global_shared_data;
     char requested_tags[ATTEST_MAX_TAGS][ATTEST_MAX_TAG_SIZE];
     int requested_tag_count;
+    int job_count;
+    bool isolate;
+    int slowest_limit;
+    int timeout_ms;
+    int max_failures;
+    int shard_index;
+    int shard_count;
+    bool shard_cases;
+    char* filter;
+    bool list_only;
+    bool run_benches;
+    unsigned long long seed;
+    char* baseline_path;
+    bool update_baseline;
+    int baseline_tolerance;
+    char* impact_map_path;
+    char* affected_path;
+    char* history_path;
+    TestOrder order;
+    bool shuffle;
+    bool shuffle_cases;
+    unsigned long long shuffle_seed;
+    char* watch_path;
+    ReportFormat format;
 } AttestContext;
 
+#ifdef ATTEST_POSIX
+// Sent by a worker process to the parent after each test. The
+// worker's report output follows as `output_size` bytes, then
+// `timing_count` entries for `--slowest`.
+typedef struct
+{
+    int test_index;
+    int total_tests;
+    int pass_count;
+    int fail_count;
+    int skip_count;
+    int empty_count;
+    int timeout_count;
+    size_t output_size;
+    int timing_count;
+    // Position of the process scoped fixture the test needs the parent
+    // to build first, or -1 once the test ran.
+    int fixture_index;
+} WorkerReport;
+
+typedef struct
+{
+    pid_t pid;
+    int command_fd;
+    int result_fd;
+    int test_index;
+} AttestWorker;
+
+void attest_request_fixture(AttestFixture* fixture);
+#endif
+
 void display_failures(int test_attempt, char* failure_report_preamble);
+void attest_render_failure(const FailureInfo* failure_info, FailureText* text);
 void report_summary();
+void attest_report_start(void);
+void attest_report_record(TestConfig* test_config, const char* reason);
+void attest_report_end(void);
+void attest_list_tests(TestConfig** selected_tests, int selected_count);
 bool has_status(Status target_status, const Status* statuses, int status_count);
 bool any_instance(Status status);
 bool every_instance(Status status);
+AttestClock attest_clock_now(void);
+AttestClock attest_clock_since(AttestClock start);
+long long attest_wall_now(void);
+int attest_main(int argc, char* argv[]);
+void attest_record_timing(TimingRecord record, const char* case_name);
+char* attest_read_text(FILE* file, size_t* size);
+void attest_print(const char* format, ...);
+void attest_emit(const char* format, ...);
+void attest_write_output(const char* bytes, size_t size);
+void attest_vemit(const char* format, va_list args);
+void attest_flush_output(void);
+void attest_record_failure(TestConfig* current_test, const FailureInfo* failure_info);
+void attest_capture_ns(CapturedValue* value, const char* label, long long raw);
+void attest_capture_int(CapturedValue* value, const char* label, long long raw);
+void attest_capture_uint(CapturedValue* value, const char* label, unsigned long long raw);
+void attest_record_success(TestConfig* current_test);
+unsigned long long attest_mix(unsigned long long value);
+void report_success();
+void report_failure(const FailureInfo* failure_info);
+ATTEST_COLD void attest_fail_int(const char* site, int line, long long actual, long long expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_uint(const char* site, int line, unsigned long long actual, unsigned long long expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_char(const char* site, int line, int actual, int expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_ptr(const char* site, int line, const void* actual, const void* expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_string(const char* site, int line, const char* actual, const char* expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_ns(const char* site, int line, long long actual, long long expected, const char* format, ...)
+    __attribute__((format(printf, 5, 6)));
+ATTEST_COLD void attest_fail_memory(const char* site, int line, const void* actual, const void* expected,
+    size_t size, size_t element_size, const char* format, ...) __attribute__((format(printf, 7, 8)));
+ATTEST_COLD void attest_fail_near(const char* site, int line, const void* actual, const void* expected,
+    size_t count, size_t element_size, size_t index, const char* format, ...) __attribute__((format(printf, 8, 9)));
+size_t attest_first_far_float(const float* actual, const float* expected, size_t count, float tolerance);
+size_t attest_first_far_double(const double* actual, const double* expected, size_t count, double tolerance);
+#ifdef ATTEST_THREADS
+void attest_merge_thread_failures(TestConfig* cfg);
+#endif
 
 /**************************
  * GLOBALS
@@ -193,21 +823,59 @@ int pass_count = 0;
 int fail_count = 0;
 int skip_count = 0;
 int empty_count = 0;
+int timeout_count = 0;
+int crash_count = 0;
+int not_run_count = 0;
 static int case_count = 0;
+// Cases the last parameterized test ran. A test that streams its cases
+// keeps only the ones that didn't pass, so `case_count` can be smaller.
+static int attest_cases_run = 0;
 
 static TestConfig* attest_registry_head = NULL;
+static TestConfig* attest_registry_tail = NULL;
+
+#ifdef ATTEST_GROWABLE_STORAGE
+// Sized in `main` once the registry is complete.
+static char** attest_seen_titles = NULL;
+static TestConfig** attest_selected_tests = NULL;
+#else
+// Open addressing set of test titles used to reject duplicates.
+static char* attest_seen_titles[ATTEST_MAX_TESTS * 2];
+static TestConfig* attest_selected_tests[ATTEST_MAX_TESTS];
+#endif
 
 FailureList failed_assertions_per_attempt[ATTEST_MAX_TEST_ATTEMPTS];
-// FailureInfo failed_verifications[ATTEST_MAX_TESTS];
-int test_attempt_count = 0;
+// One past the highest attempt that recorded a failure since the last reset.
+static int attest_dirty_attempts = 0;
+ATTEST_THREAD_LOCAL int test_attempt_count = 0;
+// Cleared by the first passing expectation of an attempt so later passes skip report_success().
+ATTEST_THREAD_LOCAL bool attest_first_success_pending = true;
+
+// Reporter output is appended here and written out once per test.
+static char attest_output[ATTEST_OUTPUT_BUF];
+static size_t attest_output_size = 0;
+static int attest_output_fd = ATTEST_OUTPUT_FD;
+
+// Requested tags by hash. Each slot holds the index of the tag in
+// `requested_tags` plus one, or zero when empty.
+static int attest_tag_slots[ATTEST_MAX_TAGS * 2];
+
+// Most expensive tests and cases, sorted by descending wall time.
+TimingRecord attest_slowest[ATTEST_MAX_SLOWEST];
+int attest_slowest_count = 0;
 // int failed_verification_count = 0;
 
+#ifdef ATTEST_GROWABLE_STORAGE
+InstanceResult* parameterize_instance_results = NULL;
+static size_t attest_case_capacity = 0;
+#else
 InstanceResult parameterize_instance_results[ATTEST_MAX_TESTS];
+#endif
 
 static void (*parameterize_before_all_cases)(ParamContext* param_ctx);
 static void (*parameterize_after_all_cases)(ParamContext* param_ctx);
 
-TestConfig* attest_internal_current_test;
+ATTEST_THREAD_LOCAL TestConfig* attest_internal_current_test;
 
 static void (*attest_before_each_handler)(TestContext* test_ctx);
 static void (*attest_before_all_handler)(GlobalContext* global_ctx);
@@ -219,247 +887,3410 @@ static void (*attest_after_each_handler)(TestContext* global_ctx);
 static AttestContext attest_context = {
     .global_shared_data = NULL,
     .requested_tags = {},
-    .requested_tag_count = 0
+    .requested_tag_count = 0,
+    .job_count = 1,
+    .isolate = false,
+    .slowest_limit = 0,
+    .timeout_ms = 0,
+    .max_failures = 0,
+    .shard_index = 0,
+    .shard_count = 0,
+    .shard_cases = false,
+    .filter = NULL,
+    .list_only = false,
+    .run_benches = false,
+    .seed = 0,
+    .baseline_path = NULL,
+    .update_baseline = false,
+    .baseline_tolerance = ATTEST_BASELINE_TOLERANCE,
+    .impact_map_path = NULL,
+    .affected_path = NULL,
+    .history_path = NULL,
+    .order = ATTEST_ORDER_DECLARED,
+    .shuffle = false,
+    .shuffle_cases = false,
+    .shuffle_seed = 0,
+    .watch_path = NULL,
+    .format = ATTEST_FORMAT_TEXT
 };
 
-static ParamContext global_param_context;
+static ATTEST_THREAD_LOCAL ParamContext global_param_context;
+// False while the cases of a test run that `--history` shows isn't
+// flaky, so their `.attempts` don't apply.
+static bool attest_case_retries = true;
+// Set when a case of the running test passed only after a retry, which
+// makes the run flaky in the history like a retried test.
+static bool attest_case_retried = false;
+// Set when the provider of a `PARAM_TEST_STREAM` yielded no cases.
+static bool attest_stream_empty = false;
+
+// Timings loaded from `--baseline`, or the file new timings go to.
+static BaselineEntry* attest_baseline = NULL;
+static size_t attest_baseline_slot_count = 0;
+// Keys of the entries point into it.
+static char* attest_baseline_text = NULL;
+static FILE* attest_baseline_out = NULL;
+// Map of `--impact-map` and the sources `--affected` lists, or the file
+// new records go to.
+static ImpactEntry* attest_impact = NULL;
+static size_t attest_impact_slot_count = 0;
+static char** attest_changed_sources = NULL;
+static int attest_changed_count = 0;
+static bool attest_changed_header = false;
+// Runs of earlier `--history`, the file this run's go to, and the
+// flaky tests the summary lists.
+static HistoryEntry* attest_history = NULL;
+static size_t attest_history_slot_count = 0;
+static FILE* attest_history_out = NULL;
+static FlakyRecord* attest_flaky = NULL;
+static int attest_flaky_count = 0;
+#ifdef ATTEST_IMPACT
+static FILE* attest_impact_out = NULL;
+// Functions entered since the test started, as offsets into the
+// executable plus 1, so 0 marks a free slot.
+static char* attest_impact_base = NULL;
+static size_t attest_impact_slots[ATTEST_IMPACT_MAX_FUNCTIONS * 2];
+static int attest_impact_used = 0;
+static bool attest_impact_recording = false;
+#endif
+// Set on threads that run cases of a `.parallel_cases` test. They
+// measure their own CPU time and don't share their test with threads
+// the case starts.
+static ATTEST_THREAD_LOCAL bool attest_case_thread = false;
+
+#ifdef ATTEST_THREADS
+// The test the main thread runs. Threads the test body starts have no
+// current test of their own. Their expectations land in a buffer per
+// thread that the main thread merges once the body returns.
+static TestConfig* attest_shared_test = NULL;
+static AttestThreadFailures* attest_thread_failures = NULL;
+// Bumped by each merge. A thread whose buffer is from an older epoch
+// starts a new one, since the merge freed the old buffer.
+static unsigned attest_failure_epoch = 1;
+static ATTEST_THREAD_LOCAL AttestThreadFailures* attest_own_failures = NULL;
+static ATTEST_THREAD_LOCAL unsigned attest_own_epoch = 0;
+#ifndef ATTEST_GROWABLE_STORAGE
+static AttestThreadFailures attest_thread_failure_pool[ATTEST_MAX_TEST_THREADS];
+static int attest_thread_failures_used = 0;
+#endif
+#endif
+
+#ifdef ATTEST_POSIX
+static sigjmp_buf attest_timeout_jump;
+static volatile sig_atomic_t attest_watchdog_armed = 0;
+#ifdef ATTEST_THREADS
+// SIGALRM goes to any thread of the process, so the handler passes it
+// on to the thread that armed the watchdog.
+static pthread_t attest_watchdog_thread;
+#endif
+#endif
+
+// Set while a body with `.abort_on_failure` runs. The first failed
+// expectation jumps back so the teardown hooks still run.
+static ATTEST_THREAD_LOCAL jmp_buf attest_abort_jump;
+static ATTEST_THREAD_LOCAL bool attest_abort_armed = false;
+
+static ATTEST_THREAD_LOCAL unsigned long long attest_choices[ATTEST_PROPERTY_MAX_CHOICES];
+static ATTEST_THREAD_LOCAL PropertyState attest_property;
+// Set while a property searches for or shrinks a counterexample.
+// Expectations then only note their outcome.
+static ATTEST_THREAD_LOCAL bool attest_property_probing = false;
+static ATTEST_THREAD_LOCAL bool attest_property_failed = false;
+static ATTEST_THREAD_LOCAL bool attest_property_checked = false;
+// Choices of the current candidate while shrinking, which happens on
+// the thread that runs the test.
+static unsigned long long attest_shrink_backup[ATTEST_PROPERTY_MAX_CHOICES];
+
+static AttestFixture* attest_fixture_head = NULL;
+#ifdef ATTEST_POSIX
+// Where a worker process sends its reports, -1 outside of workers.
+static int attest_worker_result_fd = -1;
+#endif
+// Shared fixtures that are built, latest first, so the ones built from
+// within another fixture are torn down after it.
+static AttestFixture* attest_built_fixtures = NULL;
+// File of the tests suite scoped fixtures were built for.
+static const char* attest_fixture_suite = NULL;
+static ATTEST_THREAD_LOCAL FixtureValue attest_case_fixtures[ATTEST_MAX_FIXTURES];
+static ATTEST_THREAD_LOCAL int attest_case_fixture_count = 0;
+#ifdef ATTEST_THREADS
+static pthread_mutex_t attest_fixture_lock;
+#endif
+
+#ifdef ATTEST_TRACK_ALLOCS
+// Totals of every thread since the program started.
+static long long attest_alloc_total = 0;
+static long long attest_free_total = 0;
+static long long attest_alloc_bytes_total = 0;
+static long long attest_live_bytes = 0;
+static long long attest_peak_bytes = 0;
+// Set while Attest records a failure, which allocates with growable
+// storage. Those allocations would read as leaks of the test.
+static ATTEST_THREAD_LOCAL int attest_alloc_paused = 0;
+#endif
+
+#ifdef ATTEST_PERF_COUNTERS
+// Counter group of each thread, in the order of `PerfStats`. It is
+// opened the first time the thread reads it and counts that thread
+// only. A worker of `--jobs` opens its own, as the group it inherits
+// counts the parent.
+static const unsigned long long attest_perf_events[4] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+static ATTEST_THREAD_LOCAL int attest_perf_fds[4] = { -1, -1, -1, -1 };
+static ATTEST_THREAD_LOCAL pid_t attest_perf_pid = 0;
+// Why the group could not be opened, for the failure of an expectation.
+static ATTEST_THREAD_LOCAL int attest_perf_errno = 0;
+#endif
 
 /**************************
  * ENGINES
  *************************/
-
-void attest_update_registry(TestConfig* test_config)
+#ifdef ATTEST_TRACK_ALLOCS
+void attest_note_alloc(void* ptr, size_t size)
 {
-    if (attest_registry_head == NULL) {
-        test_config->next = NULL;
-        attest_registry_head = test_config;
+    if (ptr == NULL || attest_alloc_paused) {
         return;
     }
 
-    TestConfig* pointer = attest_registry_head;
+    long long usable = (long long)malloc_usable_size(ptr);
 
-    while (pointer->next != NULL) {
-        pointer = pointer->next;
-    }
+    (void)__atomic_add_fetch(&attest_alloc_total, 1, __ATOMIC_RELAXED);
+    (void)__atomic_add_fetch(&attest_alloc_bytes_total, (long long)size, __ATOMIC_RELAXED);
+    long long live = __atomic_add_fetch(&attest_live_bytes, usable, __ATOMIC_RELAXED);
 
-    pointer->next = test_config;
-    test_config->next = NULL;
+    long long peak = __atomic_load_n(&attest_peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(
+                              &attest_peak_bytes, &peak, live,
+                              true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
 }
 
-void attester()
+void attest_note_free(long long usable)
 {
-    if (attest_internal_current_test == NULL) {
-        fprintf(stderr, "[Attest Error] Reach unreachable state");
-        exit(1);
+    if (attest_alloc_paused) {
+        return;
     }
 
-    TestConfig* cfg = attest_internal_current_test;
+    (void)__atomic_add_fetch(&attest_free_total, 1, __ATOMIC_RELAXED);
+    (void)__atomic_sub_fetch(&attest_live_bytes, usable, __ATOMIC_RELAXED);
+}
 
-    bool is_param_test = cfg->param_test != NULL;
+// Replacements for the glibc allocator. They forward to the `__libc_`
+// entry points glibc exports for this purpose.
+void* malloc(size_t size)
+{
+    void* ptr = __libc_malloc(size);
+    attest_note_alloc(ptr, size);
 
-    if (cfg->skip) {
-        skip_count += 1;
-        return;
-    }
+    return ptr;
+}
 
-    test_attempt_count = 0;
-    int max_attempts = cfg->attempts ? cfg->attempts : 1;
-    Status statuses[ATTEST_MAX_TEST_ATTEMPTS];
+void* calloc(size_t count, size_t size)
+{
+    void* ptr = __libc_calloc(count, size);
+    attest_note_alloc(ptr, count * size);
 
-    for (
-        cfg->attempt_count = 0;
-        cfg->attempt_count < max_attempts;
-        cfg->attempt_count++) {
-        TestContext context = {
-            .all = NULL,
-            .each = NULL,
-            .self = NULL
-        };
+    return ptr;
+}
 
-        global_param_context.self = NULL;
+// Counts as a free of the old block and an allocation of the new one.
+void* realloc(void* ptr, size_t size)
+{
+    long long old_usable = ptr != NULL ? (long long)malloc_usable_size(ptr) : 0;
+    void* resized = __libc_realloc(ptr, size);
 
-        if (attest_context.global_shared_data != NULL) {
-            context.all = attest_context.global_shared_data;
-        }
+    if (resized == NULL && size != 0) {
+        return NULL;
+    }
 
-        if (attest_before_each_handler != NULL && !is_param_test) {
-            attest_before_each_handler(&context);
-        }
+    if (ptr != NULL) {
+        attest_note_free(old_usable);
+    }
+    attest_note_alloc(resized, size);
 
-        if (is_param_test && cfg->before) {
-            (void)fprintf(stderr, "%s[ERROR] Use `before_each_case` instead of `before_each` for paramerterize tests.%s\n", RED, NORMAL);
-            exit(1);
-        }
+    return resized;
+}
 
-        if (cfg->before) {
-            cfg->before(&context);
-        }
+void free(void* ptr)
+{
+    if (ptr != NULL) {
+        attest_note_free((long long)malloc_usable_size(ptr));
+    }
 
-        if (cfg->before_each_case) {
-            cfg->before_each_case(&global_param_context);
-        }
+    __libc_free(ptr);
+}
 
-        if (cfg->contextual_test) {
-            cfg->contextual_test(&context);
-        } else if (cfg->simple_test) {
-            cfg->simple_test();
-        } else if (cfg->param_test) {
-            cfg->param_test(cfg);
-        } else {
-            (void)fprintf(stderr, "%s[ERROR] Attest entered invalid state. capture debug logs and file issue.%s\n", RED, NORMAL);
-            exit(1);
-        }
+void* memalign(size_t alignment, size_t size)
+{
+    void* ptr = __libc_memalign(alignment, size);
+    attest_note_alloc(ptr, size);
 
-        if (is_param_test && cfg->after) {
-            (void)fprintf(stderr, "%s[ERROR] Use `after_each_case` instead of `after_each` for paramerterize tests.%s\n", RED, NORMAL);
-            exit(1);
-        }
+    return ptr;
+}
 
-        if (cfg->after) {
-            cfg->after(&context);
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+
+    void* ptr = memalign(alignment, size);
+
+    if (ptr == NULL) {
+        return ENOMEM;
+    }
+
+    *out = ptr;
+
+    return 0;
+}
+
+AllocMark attest_alloc_mark(void)
+{
+    return (AllocMark) {
+        .allocs = __atomic_load_n(&attest_alloc_total, __ATOMIC_RELAXED),
+        .frees = __atomic_load_n(&attest_free_total, __ATOMIC_RELAXED),
+        .bytes = __atomic_load_n(&attest_alloc_bytes_total, __ATOMIC_RELAXED),
+        .live_bytes = __atomic_load_n(&attest_live_bytes, __ATOMIC_RELAXED),
+    };
+}
+
+// Starts counting the allocations of an attempt, from its first hook to
+// its last one. The peak restarts at the current usage.
+AllocMark attest_begin_alloc_window(void)
+{
+    AllocMark start = attest_alloc_mark();
+    __atomic_store_n(&attest_peak_bytes, start.live_bytes, __ATOMIC_RELAXED);
+
+    return start;
+}
+
+// Stores what the attempt allocated and, with `.check_leaks`, fails it
+// when memory is left over after `AFTER_EACH`.
+void attest_end_alloc_window(TestConfig* cfg, AllocMark start)
+{
+    AllocMark end = attest_alloc_mark();
+    long long peak = __atomic_load_n(&attest_peak_bytes, __ATOMIC_RELAXED);
+    long long leaked = end.live_bytes - start.live_bytes;
+
+    cfg->alloc_stats = (AllocStats) {
+        .allocs = end.allocs - start.allocs,
+        .frees = end.frees - start.frees,
+        .bytes = end.bytes - start.bytes,
+        .peak_bytes = peak - start.live_bytes,
+        .leaked_bytes = leaked > 0 ? leaked : 0,
+    };
+
+    if (!cfg->check_leaks || leaked <= 0) {
+        return;
+    }
+
+    FailureInfo failure_info = {
+        .filename = cfg->filename,
+        .line = cfg->line,
+        .verification = "CHECK_LEAKS",
+        .has_msg = true,
+        .has_expected_value = false,
+        .reason = "Memory the test allocated must be freed by the end of `AFTER_EACH`",
+    };
+    attest_capture_int(&failure_info.actual, "leaked bytes", leaked);
+    (void)snprintf(failure_info.msg, ATTEST_VALUE_BUF, "%lld allocations, %lld frees",
+        cfg->alloc_stats.allocs, cfg->alloc_stats.frees);
+
+    attest_alloc_paused++;
+    attest_record_failure(cfg, &failure_info);
+    attest_alloc_paused--;
+}
+
+AllocScope attest_begin_alloc_scope(
+    char* filename, int line, const char* verification, const char* reason, const char* limit_label, long long limit)
+{
+    return (AllocScope) {
+        .filename = filename,
+        .line = line,
+        .verification = verification,
+        .reason = reason,
+        .limit_label = limit_label,
+        .limit = limit,
+        .start_allocs = __atomic_load_n(&attest_alloc_total, __ATOMIC_RELAXED),
+        .active = true,
+    };
+}
+
+// Ends the block of `EXPECT_NO_ALLOC` or `EXPECT_MAX_ALLOCS` and checks
+// the allocations every thread made while it ran.
+void attest_end_alloc_scope(AllocScope* scope)
+{
+    scope->active = false;
+
+    long long allocs = __atomic_load_n(&attest_alloc_total, __ATOMIC_RELAXED) - scope->start_allocs;
+
+    if (allocs <= scope->limit) {
+        if (attest_first_success_pending) {
+            report_success();
         }
+        return;
+    }
 
+    FailureInfo failure_info = {
+        .filename = scope->filename,
+        .line = scope->line,
+        .verification = scope->verification,
+        .has_msg = false,
+        .has_expected_value = scope->limit_label != NULL,
+        .reason = scope->reason,
+    };
+    attest_capture_int(&failure_info.actual, "allocations", allocs);
+    if (scope->limit_label != NULL) {
+        attest_capture_int(&failure_info.expected, scope->limit_label, scope->limit);
+    }
 
-        if (cfg->after_each_case) {
-            cfg->after_each_case(&global_param_context);
+    report_failure(&failure_info);
+}
+#endif
+
+
+#ifdef ATTEST_PERF_COUNTERS
+void attest_close_perf_counters(void)
+{
+    for (int i = 0; i < 4; i++) {
+        if (attest_perf_fds[i] >= 0) {
+            close(attest_perf_fds[i]);
         }
+        attest_perf_fds[i] = -1;
+    }
 
-        if (attest_after_each_handler != NULL) {
-            attest_after_each_handler(&context);
+    attest_perf_pid = 0;
+}
+
+// Opens the counters as one group so they are scheduled together. Only
+// user space is counted, which unprivileged processes may do with the
+// default `perf_event_paranoid`. A counter the CPU lacks is left out.
+void attest_open_perf_counters(void)
+{
+    attest_close_perf_counters();
+    attest_perf_pid = getpid();
+
+    for (int i = 0; i < 4; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = attest_perf_events[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        attest_perf_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : attest_perf_fds[0], 0);
+
+        if (i == 0 && attest_perf_fds[0] < 0) {
+            attest_perf_errno = errno;
+            return;
         }
+    }
+}
 
-        statuses[test_attempt_count] = cfg->status;
-        test_attempt_count++;
-        if (cfg->status == PASSED || cfg->status == MISSING_EXPECTATION) {
-            break;
+// Totals of the calling thread since its group was opened. They are
+// scaled up when other users of the PMU left the group unscheduled for
+// a while.
+PerfStats attest_perf_read(void)
+{
+    PerfStats stats = { -1, -1, -1, -1 };
+    long long* values[4] = { &stats.instructions, &stats.cycles, &stats.cache_misses, &stats.branch_misses };
+
+    if (attest_perf_pid != getpid()) {
+        attest_open_perf_counters();
+    }
+
+    // Members follow the time fields in the order they joined the group.
+    unsigned long long buffer[3 + 4];
+
+    if (attest_perf_fds[0] < 0 || read(attest_perf_fds[0], buffer, sizeof buffer) < (ssize_t)(3 * sizeof buffer[0])) {
+        return stats;
+    }
+
+    double scale = buffer[2] > 0 && buffer[2] < buffer[1] ? (double)buffer[1] / (double)buffer[2] : 1;
+    unsigned long long member = 0;
+
+    for (int i = 0; i < 4 && member < buffer[0]; i++) {
+        if (attest_perf_fds[i] >= 0) {
+            *values[i] = (long long)((double)buffer[3 + member] * scale);
+            member++;
         }
     }
 
-    if (test_attempt_count > max_attempts) {
-        fprintf(stderr, "%s[ATTEST ERROR] Reach invalid state concerning test attempts. Print debug logs and file issue.%s\n", RED, NORMAL);
-        exit(1); // NOLINT
+    return stats;
+}
+
+PerfStats attest_perf_since(PerfStats start)
+{
+    PerfStats end = attest_perf_read();
+    long long* starts[4] = { &start.instructions, &start.cycles, &start.cache_misses, &start.branch_misses };
+    long long* ends[4] = { &end.instructions, &end.cycles, &end.cache_misses, &end.branch_misses };
+
+    for (int i = 0; i < 4; i++) {
+        *ends[i] = *starts[i] >= 0 && *ends[i] >= 0 ? *ends[i] - *starts[i] : -1;
     }
 
-    if (is_param_test && cfg->status == MISSING_EXPECTATION) {
-        InstanceResult instance_result = { .status = MISSING_EXPECTATION };
-        parameterize_instance_results[cfg->param_index] = instance_result;
+    return end;
+}
+
+const char* attest_perf_error_text(void)
+{
+    switch (attest_perf_errno) {
+    case 0:
+        return "The counters could not be read";
+    case ENOENT:
+    case EOPNOTSUPP:
+        return "The CPU or the virtual machine has no hardware counters";
+    case EACCES:
+    case EPERM:
+        return "Counters are not permitted, check `kernel.perf_event_paranoid`";
+    default:
+        return strerror(attest_perf_errno);
     }
+}
 
-    if (is_param_test) {
+PerfScope attest_begin_perf_scope(char* filename, int line, const char* limit_label, long long limit)
+{
+    return (PerfScope) {
+        .filename = filename,
+        .line = line,
+        .limit_label = limit_label,
+        .limit = limit,
+        .start_instructions = attest_perf_read().instructions,
+        .active = true,
+    };
+}
+
+// Ends the block of `EXPECT_MAX_INSTRUCTIONS` and checks the user space
+// instructions the calling thread retired while it ran.
+void attest_end_perf_scope(PerfScope* scope)
+{
+    scope->active = false;
+
+    long long end_instructions = attest_perf_read().instructions;
+    bool counted = scope->start_instructions >= 0 && end_instructions >= 0;
+    long long instructions = end_instructions - scope->start_instructions;
+
+    if (counted && instructions <= scope->limit) {
+        if (attest_first_success_pending) {
+            report_success();
+        }
         return;
     }
 
-    bool an_attempt_is_missing_verification = has_status(
-        MISSING_EXPECTATION,
-        statuses,
-        test_attempt_count);
+    FailureInfo failure_info = {
+        .filename = scope->filename,
+        .line = scope->line,
+        .verification = "EXPECT_MAX_INSTRUCTIONS",
+        .has_msg = !counted,
+        .has_expected_value = true,
+        .reason = counted
+            ? "Block must stay within its instruction budget"
+            : "Instructions must be countable",
+    };
+    attest_capture_int(&failure_info.expected, scope->limit_label, scope->limit);
+    attest_capture_int(&failure_info.actual, "instructions", counted ? instructions : -1);
+
+    if (!counted) {
+        (void)snprintf(failure_info.msg, ATTEST_VALUE_BUF, "%s", attest_perf_error_text());
+    }
 
-    if (an_attempt_is_missing_verification) {
-        cfg->status = MISSING_EXPECTATION;
+    report_failure(&failure_info);
+}
+#endif
+
+void attest_update_registry(TestConfig* test_config)
+{
+    test_config->next = NULL;
+
+    if (attest_registry_head == NULL) {
+        attest_registry_head = test_config;
+    } else {
+        attest_registry_tail->next = test_config;
     }
 
-    switch (cfg->status) {
-    case PASSED:
-        pass_count++;
-        break;
-    case MISSING_EXPECTATION:
-        empty_count++;
-        printf(
-            "%s[MISSING ASSERTION]%s %s%s%s\n",
-            MAGENTA,
-            NORMAL,
-            BOLD_WHITE,
-            attest_internal_current_test->test_title,
-            NORMAL);
-        printf("%s Location:%s %s%s:%d%s\n\n",
-            CYAN, NORMAL, GRAY, cfg->filename,
-            cfg->line,
-            NORMAL);
-        break;
-    case FAILED:
-        fail_count++;
-        printf(
-            "%s[FAIL]%s %s%s%s\n",
-            RED, NORMAL, BOLD_WHITE,
-            cfg->test_title,
-            NORMAL);
-        bool more_than_one_attempt = test_attempt_count > 1;
-        for (int i = 0; i < test_attempt_count; i++) {
-            bool is_last_attempt = i == test_attempt_count - 1;
+    attest_registry_tail = test_config;
+}
 
-            if (more_than_one_attempt) {
-                printf("%s%sTest attempt: %d%s\n",
-                    GRAY,
-                    is_last_attempt ? LEAF : BRANCH,
-                    i + 1,
-                    NORMAL);
-            }
+void attest_register_fixture(AttestFixture* fixture)
+{
+#ifdef ATTEST_THREADS
+    if (attest_fixture_head == NULL) {
+        // Recursive, since a fixture may use other fixtures while it is built.
+        pthread_mutexattr_t attributes;
+        (void)pthread_mutexattr_init(&attributes);
+        (void)pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+        (void)pthread_mutex_init(&attest_fixture_lock, &attributes);
+        (void)pthread_mutexattr_destroy(&attributes);
+    }
+#endif
 
-            if (more_than_one_attempt) {
-                display_failures(
-                    i,
-                    is_last_attempt
-                        ? "   "
-                        : TRUNK "  ");
-            } else {
-                display_failures(i, "");
-            }
+    fixture->next = attest_fixture_head;
+    attest_fixture_head = fixture;
+}
+
+void* attest_use_case_fixture(AttestFixture* fixture)
+{
+    for (int i = 0; i < attest_case_fixture_count; i++) {
+        if (attest_case_fixtures[i].fixture == fixture) {
+            return attest_case_fixtures[i].value;
         }
-        break;
-    default:
-        fprintf(stderr, "%s[ATTEST ERROR] Reach unreachable state. Print debug logs and file issue%s\n", RED, NORMAL);
     }
+
+    void* value = fixture->setup();
+
+    if (attest_case_fixture_count >= ATTEST_MAX_FIXTURES) {
+        fprintf(stderr,
+            "%s[ERROR] Reached max allowed case scoped fixtures. Define MACRO "
+            "ATTEST_MAX_FIXTURES to higher limit.%s\n",
+            RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    attest_case_fixtures[attest_case_fixture_count++] = (FixtureValue) {
+        .fixture = fixture,
+        .value = value,
+    };
+
+    return value;
 }
 
-void run_parameterize_test(TestConfig* test_config)
+// Value of `fixture` for the running scope. The first use builds it.
+void* attest_use_fixture(AttestFixture* fixture)
 {
-    test_config->param_init();
+    if (fixture->scope == ATTEST_SCOPE_CASE) {
+        return attest_use_case_fixture(fixture);
+    }
 
-    if (case_count == 0) {
-        fprintf(stderr, "%s[ATTEST ERROR] Pass values enclosed within parenthesis when using `PARAM_TEST` or `PARAM_TEST_CTX`.%s\n", RED, NORMAL);
-        exit(1); // NOLINT
+#ifdef ATTEST_THREADS
+    if (__atomic_load_n(&fixture->built, __ATOMIC_ACQUIRE)) {
+        return fixture->value;
     }
 
-    global_param_context.all = attest_context.global_shared_data;
+    (void)pthread_mutex_lock(&attest_fixture_lock);
+#endif
 
-    if (parameterize_before_all_cases != NULL) {
-        parameterize_before_all_cases(&global_param_context);
+    if (!fixture->built) {
+#ifdef ATTEST_POSIX
+        // Built in the parent, so every worker started after it inherits
+        // the value instead of building its own.
+        if (fixture->scope == ATTEST_SCOPE_PROCESS && attest_worker_result_fd >= 0) {
+            attest_request_fixture(fixture);
+        }
+#endif
+        fixture->value = fixture->setup();
+        fixture->built_below = attest_built_fixtures;
+        attest_built_fixtures = fixture;
+#ifdef ATTEST_THREADS
+        __atomic_store_n(&fixture->built, true, __ATOMIC_RELEASE);
+#else
+        fixture->built = true;
+#endif
     }
 
-    test_config->param_test_runner();
+#ifdef ATTEST_THREADS
+    (void)pthread_mutex_unlock(&attest_fixture_lock);
+#endif
 
-    bool empty_tests_are_present = any_instance(MISSING_EXPECTATION);
+    return fixture->value;
+}
 
-    bool every_instance_pass = every_instance(PASSED);
+// Tears down the shared fixtures of `scope`, latest built first.
+void attest_teardown_fixtures(FixtureScope scope)
+{
+    AttestFixture** link = &attest_built_fixtures;
 
-    if (every_instance_pass) {
-        pass_count++;
-    } else if (empty_tests_are_present) {
-        empty_count++;
-        printf(
-            "%s[MISSING ASSERTION]%s %s%s%s\n",
-            MAGENTA,
-            NORMAL,
-            BOLD_WHITE, test_config->test_title, NORMAL);
-        printf(
-            "%s NOTE:%s Every case of a pareametize test must have atleast one expectation.\n",
-            CYAN, NORMAL);
-        printf("%s Location:%s %s%s:%d%s\n\n",
-            CYAN, NORMAL, GRAY, test_config->filename,
-            test_config->line, NORMAL);
+    while (*link != NULL) {
+        AttestFixture* fixture = *link;
+
+        if (fixture->scope != scope) {
+            link = &fixture->built_below;
+            continue;
+        }
+
+        *link = fixture->built_below;
+        fixture->built = false;
+
+        if (fixture->teardown != NULL) {
+            fixture->teardown(fixture->value);
+        }
+        fixture->value = NULL;
+    }
+}
+
+// Tears down the case scoped fixtures of the calling thread.
+void attest_teardown_case_fixtures(void)
+{
+    while (attest_case_fixture_count > 0) {
+        FixtureValue* entry = &attest_case_fixtures[--attest_case_fixture_count];
+
+        if (entry->fixture->teardown != NULL) {
+            entry->fixture->teardown(entry->value);
+        }
+    }
+}
+
+// FNV-1a, continued from `hash` so several strings can be combined.
+unsigned long attest_hash_append(unsigned long hash, const char* text)
+{
+    for (; *text != '\0'; text++) {
+        hash ^= (unsigned char)*text;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+unsigned long attest_hash_string(const char* text)
+{
+    return attest_hash_append(2166136261UL, text);
+}
+
+// Shard that owns a test, or a case when `case_key` is set. Only the
+// low 32 bits are used so every platform assigns the same shard, and
+// the assignment of a test never changes when other tests are added.
+int attest_shard_of(const char* title, const char* filename, const char* case_key)
+{
+    // Only the base name of the file counts, since `__FILE__` carries the
+    // path the compiler was given, which differs between checkouts.
+    const char* base_name = filename;
+    for (const char* c = filename; *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') {
+            base_name = c + 1;
+        }
+    }
+
+    unsigned long hash = attest_hash_append(attest_hash_string(title), "\n");
+    hash = attest_hash_append(hash, base_name);
+
+    if (case_key != NULL) {
+        hash = attest_hash_append(attest_hash_append(hash, "\n"), case_key);
+    }
+
+    // FNV alone clusters similar titles such as `test_1` and `test_2`,
+    // so the bits are mixed with the murmur3 finalizer first.
+    hash &= 0xFFFFFFFFUL;
+    hash ^= hash >> 16;
+    hash = (hash * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+    hash ^= hash >> 13;
+    hash = (hash * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+    hash ^= hash >> 16;
+
+    return (int)(hash % (unsigned long)attest_context.shard_count);
+}
+
+// True when `--shard` assigns the case to this process. Named cases
+// are keyed by name so inserting a case does not move the others.
+bool attest_owns_case(const char* title, const char* filename, const char* case_name, int case_index)
+{
+    if (!attest_context.shard_cases || attest_context.shard_count == 0) {
+        return true;
+    }
+
+    char case_key[ATTEST_CASE_NAME_SIZE + 16];
+
+    if (case_name[0] != '\0') {
+        (void)snprintf(case_key, sizeof case_key, "%s", case_name);
     } else {
-        fail_count++;
+        (void)snprintf(case_key, sizeof case_key, "#%d", case_index);
+    }
 
-        int amount_of_failed_cases = 0;
-        InstanceResult* failed_cases[ATTEST_MAX_TESTS];
+    return attest_shard_of(title, filename, case_key) == attest_context.shard_index;
+}
 
-        for (int i = 0; i < case_count; i++) {
-            switch (parameterize_instance_results[i].status) {
-            case PASSED:
+// Returns false when the title is already in the set.
+bool attest_insert_title(char** slots, size_t slot_count, char* title)
+{
+    size_t slot = attest_hash_string(title) % slot_count;
+
+    while (slots[slot] != NULL) {
+        if (strcmp(slots[slot], title) == 0) {
+            return false;
+        }
+        slot = (slot + 1) % slot_count;
+    }
+
+    slots[slot] = title;
+
+    return true;
+}
+
+// Interns the tags passed with `--tag` so a test tag costs one hash
+// lookup instead of a comparison with every requested tag.
+void attest_index_requested_tags(void)
+{
+    size_t slot_count = sizeof attest_tag_slots / sizeof attest_tag_slots[0];
+
+    for (int i = 0; i < attest_context.requested_tag_count; i++) {
+        char* tag = attest_context.requested_tags[i];
+        size_t slot = attest_hash_string(tag) % slot_count;
+        bool is_duplicate = false;
+
+        while (attest_tag_slots[slot] != 0) {
+            if (strcmp(attest_context.requested_tags[attest_tag_slots[slot] - 1], tag) == 0) {
+                is_duplicate = true;
                 break;
-            case FAILED:
-                failed_cases[amount_of_failed_cases] = &parameterize_instance_results[i];
-                amount_of_failed_cases++;
+            }
+            slot = (slot + 1) % slot_count;
+        }
+
+        if (!is_duplicate) {
+            attest_tag_slots[slot] = i + 1;
+        }
+    }
+}
+
+// Bit set of the requested tags the test carries.
+unsigned long long attest_tag_mask(const TestConfig* test_config)
+{
+    size_t slot_count = sizeof attest_tag_slots / sizeof attest_tag_slots[0];
+    unsigned long long mask = 0;
+
+    for (int j = 0; j < ATTEST_MAX_TAGS && test_config->tags[j] != NULL; j++) {
+        char* test_tag = test_config->tags[j];
+        size_t slot = attest_hash_string(test_tag) % slot_count;
+
+        while (attest_tag_slots[slot] != 0) {
+            int tag_id = attest_tag_slots[slot] - 1;
+            if (strcmp(attest_context.requested_tags[tag_id], test_tag) == 0) {
+                mask |= 1ULL << tag_id;
+                break;
+            }
+            slot = (slot + 1) % slot_count;
+        }
+    }
+
+    return mask;
+}
+
+// Matches `text` against a glob where `*` is any run of characters and
+// `?` is any single character. Only the last star is retried, so the
+// cost stays linear for the usual `prefix*` and `*suffix` patterns.
+bool attest_glob_match(const char* pattern, const char* text)
+{
+    const char* star = NULL;
+    const char* resume = NULL;
+
+    while (*text != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = text;
+        } else if (*pattern == '?' || *pattern == *text) {
+            pattern++;
+            text++;
+        } else if (star != NULL) {
+            pattern = star + 1;
+            text = ++resume;
+        } else {
+            return false;
+        }
+    }
+
+    while (*pattern == '*') {
+        pattern++;
+    }
+
+    return *pattern == '\0';
+}
+
+#ifdef ATTEST_GROWABLE_STORAGE
+// Grows `items` geometrically until it holds `needed` items. New items
+// are zeroed.
+void* attest_grow(void* items, size_t* capacity, size_t needed, size_t item_size)
+{
+    if (needed <= *capacity) {
+        return items;
+    }
+
+    size_t new_capacity = *capacity > 0 ? *capacity : 8;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    char* grown = realloc(items, new_capacity * item_size);
+
+    if (grown == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while growing test storage.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    memset(grown + (*capacity * item_size), 0, (new_capacity - *capacity) * item_size);
+    *capacity = new_capacity;
+
+    return grown;
+}
+#endif
+
+// Returns the slot for the next failure of a case, or NULL once the
+// case reached `ATTEST_MAX_PARAMERTERIZE_RESULTS` in fixed storage.
+FailureInfo* attest_next_case_failure(InstanceResult* case_result)
+{
+#ifdef ATTEST_GROWABLE_STORAGE
+    case_result->failures = attest_grow(
+        case_result->failures,
+        &case_result->failure_capacity,
+        (size_t)case_result->failure_count + 1,
+        sizeof(FailureInfo));
+#else
+    if (case_result->failure_count == ATTEST_MAX_PARAMERTERIZE_RESULTS) {
+        return NULL;
+    }
+#endif
+
+    FailureInfo* slot = &case_result->failures[case_result->failure_count];
+    case_result->failure_count++;
+
+    return slot;
+}
+
+// Returns the slot for the next failure of an attempt, or NULL once the
+// attempt reached `ATTEST_MAX_FAILURES` in fixed storage.
+FailureInfo* attest_next_attempt_failure(FailureList* failure_list)
+{
+#ifdef ATTEST_GROWABLE_STORAGE
+    failure_list->failures = attest_grow(
+        failure_list->failures,
+        &failure_list->capacity,
+        failure_list->count + 1,
+        sizeof(FailureInfo));
+#else
+    if (failure_list->count == ATTEST_MAX_FAILURES) {
+        return NULL;
+    }
+#endif
+
+    FailureInfo* slot = &failure_list->failures[failure_list->count];
+    failure_list->count++;
+
+    return slot;
+}
+
+// Makes room for the cases of the next parameterized test.
+void attest_reserve_cases(int amount_of_cases)
+{
+#ifdef ATTEST_GROWABLE_STORAGE
+    parameterize_instance_results = attest_grow(
+        parameterize_instance_results,
+        &attest_case_capacity,
+        (size_t)amount_of_cases,
+        sizeof(InstanceResult));
+#else
+    if (amount_of_cases > ATTEST_MAX_TESTS) {
+        fprintf(stderr,
+            "%s[ERROR] Reached max allowed cases for a parameterize test. Define MACRO "
+            "ATTEST_MAX_TESTS to higher limit or define ATTEST_GROWABLE_STORAGE.%s\n",
+            RED, NORMAL);
+        exit(1); // NOLINT
+    }
+#endif
+}
+
+// Failure slots are only read up to `failure_count`, so they are left
+// as is and the cost depends on the amount of cases, not on the
+// storage size.
+void attest_reset_case(InstanceResult* case_result)
+{
+    case_result->case_name = NULL;
+    case_result->status = MISSING_EXPECTATION;
+    case_result->failure_count = 0;
+    case_result->has_status = false;
+    case_result->wall_ns = 0;
+    case_result->cpu_ns = 0;
+}
+
+// Clears the case results of the last parameterized test.
+void attest_reset_cases(int amount_of_cases)
+{
+    for (int i = 0; i < amount_of_cases; i++) {
+        attest_reset_case(&parameterize_instance_results[i]);
+    }
+}
+
+// Clears the failure lists of the attempts that recorded a failure.
+void attest_reset_attempts(void)
+{
+    for (int i = 0; i < attest_dirty_attempts; i++) {
+        failed_assertions_per_attempt[i].count = 0;
+    }
+
+    attest_dirty_attempts = 0;
+}
+
+#ifdef ATTEST_THREADS
+typedef struct
+{
+    AttestCaseRunner run_case;
+    ParamContext param_context;
+    pthread_mutex_t lock;
+    int next_slot;
+    int slot_count;
+} AttestCasePool;
+
+// Starts a thread of Attest with SIGALRM blocked, so the watchdog never
+// interrupts it. The thread inherits the mask it is created with.
+int attest_start_thread(pthread_t* thread, void* (*start)(void*), void* argument)
+{
+    sigset_t blocked;
+    sigset_t previous;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGALRM);
+
+    (void)pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+    int result = pthread_create(thread, NULL, start, argument);
+    (void)pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    return result;
+}
+
+// Takes cases from the pool until none are left. Every thread starts
+// from the context `before_all_cases` prepared on the main thread.
+void* attest_case_worker(void* argument)
+{
+    AttestCasePool* pool = argument;
+
+    global_param_context = pool->param_context;
+    attest_case_thread = true;
+
+    for (;;) {
+        (void)pthread_mutex_lock(&pool->lock);
+        int slot = pool->next_slot++;
+        (void)pthread_mutex_unlock(&pool->lock);
+
+        if (slot >= pool->slot_count) {
+            break;
+        }
+
+        pool->run_case(slot, parameterize_instance_results[slot].case_index);
+    }
+
+    attest_case_thread = false;
+#ifdef ATTEST_PERF_COUNTERS
+    attest_close_perf_counters();
+#endif
+
+    return NULL;
+}
+
+// Runs the cases on up to one thread per CPU. The main thread takes
+// part, so the cases still run when no thread can be started. Results
+// land in their own slot, which keeps the report in case order.
+void attest_run_cases_in_threads(AttestCaseRunner run_case, int slot_count)
+{
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = cpu_count > 1 ? (int)cpu_count : 1;
+
+    if (thread_count > ATTEST_MAX_CASE_THREADS) {
+        thread_count = ATTEST_MAX_CASE_THREADS;
+    }
+
+    if (thread_count > slot_count) {
+        thread_count = slot_count;
+    }
+
+    AttestCasePool pool = {
+        .run_case = run_case,
+        .param_context = global_param_context,
+        .next_slot = 0,
+        .slot_count = slot_count
+    };
+    (void)pthread_mutex_init(&pool.lock, NULL);
+
+    pthread_t threads[ATTEST_MAX_CASE_THREADS];
+    int started = 0;
+
+    for (int i = 1; i < thread_count; i++) {
+        if (attest_start_thread(&threads[started], attest_case_worker, &pool) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    ParamContext main_context = global_param_context;
+    (void)attest_case_worker(&pool);
+    global_param_context = main_context;
+
+    for (int i = 0; i < started; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+
+    (void)pthread_mutex_destroy(&pool.lock);
+}
+#endif
+
+// Runs the cases of a parameterized test that belong to this shard.
+// They are first packed into consecutive result slots, then run in
+// order or, with `.parallel_cases`, on a thread pool.
+void attest_run_cases(
+    const char* title,
+    const char* filename,
+    const TestConfig* options,
+    char* (*case_name_of)(int case_index),
+    AttestCaseRunner run_case)
+{
+    int slot_count = 0;
+
+    for (int i = 0; i < case_count; i++) {
+        char* case_name = case_name_of(i);
+
+        if (attest_owns_case(title, filename, case_name, i)) {
+            parameterize_instance_results[slot_count].case_index = i;
+            parameterize_instance_results[slot_count].case_name = case_name;
+            slot_count++;
+        }
+    }
+
+    case_count = slot_count;
+    attest_cases_run = slot_count;
+
+#ifdef ATTEST_THREADS
+    // The watchdog is a process wide timer, so cases with a timeout stay
+    // on the main thread.
+    bool has_timeout = options->timeout_ms > 0 || attest_context.timeout_ms > 0;
+
+    if (options->parallel_cases && !options->skip && !has_timeout && slot_count > 1) {
+        attest_run_cases_in_threads(run_case, slot_count);
+        return;
+    }
+#else
+    (void)options;
+#endif
+
+    // With `--shuffle-cases` the cases run in a permuted order. Results
+    // keep their slot, so the report stays in case order.
+    int* order = NULL;
+    if (attest_context.shuffle && attest_context.shuffle_cases && slot_count > 1) {
+        ATTEST_PAUSE_ALLOCS();
+        order = malloc(sizeof(int) * (size_t)slot_count);
+        ATTEST_RESUME_ALLOCS();
+    }
+
+    if (order != NULL) {
+        unsigned long long state = attest_context.shuffle_seed ^ attest_hash_string(title);
+        for (int slot = 0; slot < slot_count; slot++) {
+            order[slot] = slot;
+        }
+        for (int slot = slot_count - 1; slot > 0; slot--) {
+            state = attest_mix(state);
+            int other = (int)(state % (unsigned long long)(slot + 1));
+            int swapped = order[slot];
+            order[slot] = order[other];
+            order[other] = swapped;
+        }
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        int slot = order != NULL ? order[i] : i;
+        run_case(slot, parameterize_instance_results[slot].case_index);
+    }
+
+    ATTEST_PAUSE_ALLOCS();
+    free(order);
+    ATTEST_RESUME_ALLOCS();
+}
+
+// Runs the cases a provider hands out, one at a time. Cases that pass
+// give their slot to the next case, so memory grows with the failures
+// and not with the amount of cases.
+void attest_stream_cases(
+    const TestConfig* options,
+    bool (*next_case)(int case_index),
+    char* (*case_name_of)(int case_index),
+    AttestCaseRunner run_case)
+{
+    int slot = 0;
+    int provided = 0;
+
+    for (int i = 0; next_case(i); i++) {
+        provided++;
+        char* case_name = case_name_of(i);
+
+        if (!attest_owns_case(options->test_title, options->filename, case_name, i)) {
+            continue;
+        }
+
+        attest_reserve_cases(slot + 1);
+        InstanceResult* case_result = &parameterize_instance_results[slot];
+        case_result->case_index = i;
+        case_result->case_name = case_name;
+
+        run_case(slot, i);
+        attest_cases_run++;
+
+        if (case_result->status == PASSED) {
+            attest_record_timing((TimingRecord) {
+                .test_title = options->test_title,
+                .case_index = i,
+                .filename = options->filename,
+                .line = options->line,
+                .wall_ns = case_result->wall_ns,
+                .cpu_ns = case_result->cpu_ns },
+                case_name);
+            attest_reset_case(case_result);
+            continue;
+        }
+
+        (void)snprintf(case_result->kept_name, sizeof case_result->kept_name, "%s", case_name);
+        slot++;
+    }
+
+    attest_stream_empty = provided == 0;
+
+    // Growable storage may have moved the results while they were kept.
+    for (int i = 0; i < slot; i++) {
+        parameterize_instance_results[i].case_name = parameterize_instance_results[i].kept_name;
+    }
+
+    case_count = slot;
+}
+
+#ifdef ATTEST_POSIX
+void attest_on_watchdog(int signal_number)
+{
+#ifdef ATTEST_THREADS
+    if (!pthread_equal(pthread_self(), attest_watchdog_thread)) {
+        (void)pthread_kill(attest_watchdog_thread, signal_number);
+        return;
+    }
+#endif
+    (void)signal_number;
+
+    if (attest_watchdog_armed) {
+        attest_watchdog_armed = 0;
+        siglongjmp(attest_timeout_jump, 1);
+    }
+}
+
+void attest_arm_watchdog(int timeout_ms)
+{
+    static bool handler_installed = false;
+
+    if (!handler_installed) {
+        struct sigaction action;
+        memset(&action, 0, sizeof action);
+        action.sa_handler = attest_on_watchdog;
+        sigemptyset(&action.sa_mask);
+        (void)sigaction(SIGALRM, &action, NULL);
+        handler_installed = true;
+    }
+
+    struct itimerval timer = {
+        .it_value = {
+            .tv_sec = timeout_ms / 1000,
+            .tv_usec = (suseconds_t)(timeout_ms % 1000) * 1000 }
+    };
+
+#ifdef ATTEST_THREADS
+    attest_watchdog_thread = pthread_self();
+#endif
+    attest_watchdog_armed = 1;
+    (void)setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+void attest_disarm_watchdog(void)
+{
+    struct itimerval timer;
+    memset(&timer, 0, sizeof timer);
+    (void)setitimer(ITIMER_REAL, &timer, NULL);
+    attest_watchdog_armed = 0;
+}
+#endif
+
+// Newton's method, so benchmarks don't need to link libm.
+double attest_sqrt(double value)
+{
+    if (value <= 0) {
+        return 0;
+    }
+
+    double root = value > 1 ? value : 1;
+    for (int i = 0; i < 64; i++) {
+        double next = (root + value / root) / 2;
+        if (next >= root) {
+            break;
+        }
+        root = next;
+    }
+
+    return root;
+}
+
+// Runs the body of a benchmark `iterations` times and returns the wall
+// time it took.
+long long attest_bench_batch(TestConfig* cfg, TestContext* context, long long iterations)
+{
+    long long start_ns = attest_wall_now();
+
+    for (long long i = 0; i < iterations; i++) {
+        cfg->benchmark(context);
+    }
+
+    return attest_wall_now() - start_ns;
+}
+
+// Finds an iteration count that fills `ATTEST_BENCH_SAMPLE_MS`, keeps
+// running until `ATTEST_BENCH_WARMUP_MS` passed, then times
+// `ATTEST_BENCH_SAMPLES` batches of that size.
+void attest_measure_bench(TestConfig* cfg, TestContext* context)
+{
+    long long sample_target_ns = (long long)ATTEST_BENCH_SAMPLE_MS * 1000000LL;
+    long long warmup_target_ns = (long long)ATTEST_BENCH_WARMUP_MS * 1000000LL;
+    long long warmup_ns = 0;
+    long long iterations = 1;
+
+    for (;;) {
+        long long elapsed_ns = attest_bench_batch(cfg, context, iterations);
+        warmup_ns += elapsed_ns;
+
+        if (cfg->status == FAILED) {
+            return;
+        }
+
+        if (elapsed_ns < sample_target_ns && iterations < 1000000000000LL) {
+            // Aim a bit past the target, but grow at most tenfold per
+            // step since a cold first batch runs slow.
+            double wanted = elapsed_ns > 0
+                ? (double)iterations * 1.2 * (double)sample_target_ns / (double)elapsed_ns
+                : (double)iterations * 10;
+            long long next = wanted > (double)iterations * 10 ? iterations * 10 : (long long)wanted;
+            iterations = next > iterations ? next : iterations + 1;
+        } else if (warmup_ns >= warmup_target_ns) {
+            break;
+        }
+    }
+
+    double samples[ATTEST_BENCH_SAMPLES];
+    double total = 0;
+    PerfStats perf = { -1, -1, -1, -1 };
+#ifdef ATTEST_PERF_COUNTERS
+    PerfStats perf_start = attest_perf_read();
+#endif
+
+    for (int i = 0; i < ATTEST_BENCH_SAMPLES; i++) {
+        double sample = (double)attest_bench_batch(cfg, context, iterations) / (double)iterations;
+
+        if (cfg->status == FAILED) {
+            return;
+        }
+
+        // Insertion sort, the sample count is small.
+        int j = i;
+        while (j > 0 && samples[j - 1] > sample) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = sample;
+        total += sample;
+    }
+
+#ifdef ATTEST_PERF_COUNTERS
+    perf = attest_perf_since(perf_start);
+#endif
+
+    int count = ATTEST_BENCH_SAMPLES;
+    double mean = total / count;
+    double squares = 0;
+
+    for (int i = 0; i < count; i++) {
+        squares += (samples[i] - mean) * (samples[i] - mean);
+    }
+
+    // Nearest rank, so the p99 of few samples is the slowest one.
+    int p99_rank = (count * 99 + 99) / 100;
+
+    cfg->bench_stats = (BenchStats) {
+        .iterations = iterations,
+        .samples = count,
+        .mean_ns = mean,
+        .median_ns = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2,
+        .p99_ns = samples[p99_rank - 1],
+        .stddev_ns = count > 1 ? attest_sqrt(squares / (count - 1)) : 0,
+        .perf = perf,
+    };
+
+    // A benchmark doesn't need expectations. Failed ones still count.
+    if (cfg->status == MISSING_EXPECTATION) {
+        cfg->status = PASSED;
+    }
+}
+
+// splitmix64, a fast generator with good output for sequential seeds.
+unsigned long long attest_mix(unsigned long long value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+unsigned long long attest_random(void)
+{
+    attest_property.rng += 0x9E3779B97F4A7C15ULL;
+
+    return attest_mix(attest_property.rng);
+}
+
+// Records `generated` while exploring, or hands back the recorded choice
+// while replaying. Choices are clamped to `bound` since the shrinker
+// may leave values a generator doesn't accept.
+unsigned long long attest_choice(unsigned long long generated, unsigned long long bound)
+{
+    PropertyState* state = &attest_property;
+    int position = state->position++;
+
+    if (position >= ATTEST_PROPERTY_MAX_CHOICES) {
+        return 0;
+    }
+
+    if (!state->replaying) {
+        attest_choices[position] = generated;
+        state->count = position + 1;
+        return generated;
+    }
+
+    if (position >= state->count) {
+        attest_choices[position] = 0;
+        state->count = position + 1;
+    }
+
+    if (attest_choices[position] > bound) {
+        attest_choices[position] = bound;
+    }
+
+    return attest_choices[position];
+}
+
+void attest_describe_input(const char* format, ...)
+{
+    PropertyState* state = &attest_property;
+
+    if (!state->describing || state->inputs_length >= sizeof state->inputs - 1) {
+        return;
+    }
+
+    size_t room = sizeof state->inputs - state->inputs_length;
+
+    if (state->inputs_length > 0) {
+        int written = snprintf(state->inputs + state->inputs_length, room, ", ");
+        state->inputs_length += (size_t)written < room ? (size_t)written : room - 1;
+        room = sizeof state->inputs - state->inputs_length;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(state->inputs + state->inputs_length, room, format, args);
+    va_end(args);
+
+    if (written > 0) {
+        state->inputs_length += (size_t)written < room ? (size_t)written : room - 1;
+    }
+}
+
+// Uniform over the range, with a bias towards its ends and its origin
+// where bugs tend to hide.
+long long attest_sample_range(long long min, long long max, long long origin)
+{
+    unsigned long long roll = attest_random();
+
+    switch (roll & 31) {
+    case 0:
+        return min;
+    case 1:
+        return max;
+    case 2:
+        return origin;
+    default:
+        break;
+    }
+
+    unsigned long long span = (unsigned long long)max - (unsigned long long)min;
+    unsigned long long offset = span == ULLONG_MAX ? attest_random() : attest_random() % (span + 1);
+
+    return (long long)((unsigned long long)min + offset);
+}
+
+// The value is recorded as its side of the origin and its distance to
+// it. The origin is 0, or the bound closest to 0, so inputs shrink
+// towards it.
+long long attest_gen_range(long long min, long long max)
+{
+    if (min > max) {
+        (void)fprintf(stderr, "%s[ERROR] `GEN_RANGE` needs its min to be at most its max.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    long long origin = min > 0 ? min : (max < 0 ? max : 0);
+    unsigned long long above = (unsigned long long)max - (unsigned long long)origin;
+    unsigned long long below = (unsigned long long)origin - (unsigned long long)min;
+
+    long long sample = attest_property.replaying ? origin : attest_sample_range(min, max, origin);
+    bool is_below = sample < origin;
+    unsigned long long distance = is_below
+        ? (unsigned long long)origin - (unsigned long long)sample
+        : (unsigned long long)sample - (unsigned long long)origin;
+
+    if (above > 0 && below > 0) {
+        is_below = attest_choice(is_below, 1) == 1;
+    } else {
+        is_below = below > 0;
+    }
+
+    distance = attest_choice(distance, is_below ? below : above);
+
+    long long value = is_below
+        ? (long long)((unsigned long long)origin - distance)
+        : (long long)((unsigned long long)origin + distance);
+
+    attest_describe_input("%lld", value);
+
+    return value;
+}
+
+// Length first, so shrinking can drop trailing bytes, then each byte.
+size_t attest_gen_bytes(unsigned char* buffer, size_t max_size)
+{
+    bool replaying = attest_property.replaying;
+    size_t size = (size_t)attest_choice(replaying ? 0 : attest_random() % (max_size + 1), max_size);
+
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = (unsigned char)attest_choice(replaying ? 0 : attest_random() & 0xFF, 0xFF);
+    }
+
+    if (attest_property.describing) {
+        char hex[ATTEST_VALUE_BUF];
+        size_t length = 0;
+        for (size_t i = 0; i < size && length + 4 < sizeof hex; i++) {
+            length += (size_t)snprintf(hex + length, sizeof hex - length, i == 0 ? "%02x" : " %02x", buffer[i]);
+        }
+        hex[length] = '\0';
+        attest_describe_input("%zu bytes {%s}", size, hex);
+    }
+
+    return size;
+}
+
+// Printable ASCII, where choice 0 is 'a' so shrunk strings stay readable.
+// `buffer` needs room for `max_length` characters and the terminator.
+char* attest_gen_string(char* buffer, size_t max_length)
+{
+    bool replaying = attest_property.replaying;
+    size_t length = (size_t)attest_choice(replaying ? 0 : attest_random() % (max_length + 1), max_length);
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned long long choice = attest_choice(replaying ? 0 : attest_random() % 95, 94);
+        buffer[i] = (char)(' ' + ((int)choice + 'a' - ' ') % 95);
+    }
+    buffer[length] = '\0';
+
+    attest_describe_input("\"%s\"", buffer);
+
+    return buffer;
+}
+
+// Runs the property body once and tells if an expectation failed.
+bool attest_property_fails(TestConfig* cfg, bool replaying)
+{
+    attest_property.position = 0;
+    attest_property.replaying = replaying;
+    attest_property_failed = false;
+
+    cfg->property();
+
+    if (attest_property.position < attest_property.count) {
+        attest_property.count = attest_property.position;
+    }
+
+    return attest_property_failed;
+}
+
+bool attest_property_iteration_fails(TestConfig* cfg, unsigned long long seed, int iteration)
+{
+    attest_property.rng = attest_mix(seed ^ (unsigned long long)iteration);
+    attest_property.count = 0;
+
+    return attest_property_fails(cfg, false);
+}
+
+typedef struct
+{
+    TestConfig* cfg;
+    unsigned long long seed;
+    int iterations;
+    int thread_count;
+    int next_thread;
+    // Lowest failing iteration found so far, or `iterations` when none.
+    int first_failure;
+    bool checked;
+} PropertySearch;
+
+// Tries every `thread_count`-th iteration and stops past a failure
+// another thread already found, so the lowest failing iteration wins
+// however the threads interleave.
+void* attest_search_property(void* argument)
+{
+    PropertySearch* search = argument;
+    int offset = __atomic_fetch_add(&search->next_thread, 1, __ATOMIC_RELAXED);
+
+    attest_property_probing = true;
+    attest_property_checked = false;
+    attest_first_success_pending = true;
+
+    for (int i = offset; i < search->iterations; i += search->thread_count) {
+        if (i > __atomic_load_n(&search->first_failure, __ATOMIC_RELAXED)) {
+            break;
+        }
+
+        if (attest_property_iteration_fails(search->cfg, search->seed, i)) {
+            int known = __atomic_load_n(&search->first_failure, __ATOMIC_RELAXED);
+            while (i < known && !__atomic_compare_exchange_n(
+                                    &search->first_failure, &known, i,
+                                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+            break;
+        }
+    }
+
+    if (attest_property_checked) {
+        __atomic_store_n(&search->checked, true, __ATOMIC_RELAXED);
+    }
+    attest_property_probing = false;
+
+    return NULL;
+}
+
+// Keeps the candidate in `attest_choices` when it still fails and is
+// simpler than the backup: fewer choices, or smaller ones at the first
+// difference. Otherwise the backup comes back. Replays pad choices they
+// run out of with zeros, so comparing stops the shrinker from accepting
+// the same input forever.
+bool attest_try_shrink(TestConfig* cfg, int backup_count)
+{
+    bool simpler = false;
+
+    if (attest_property_fails(cfg, true)) {
+        int count = attest_property.count;
+        simpler = count < backup_count;
+
+        for (int i = 0; count == backup_count && i < count; i++) {
+            if (attest_choices[i] != attest_shrink_backup[i]) {
+                simpler = attest_choices[i] < attest_shrink_backup[i];
+                break;
+            }
+        }
+    }
+
+    if (!simpler) {
+        memcpy(attest_choices, attest_shrink_backup, sizeof(unsigned long long) * (size_t)backup_count);
+        attest_property.count = backup_count;
+    }
+
+    return simpler;
+}
+
+// Replays smaller choices while the property keeps failing. Blocks of
+// choices are removed first, then each choice is moved towards 0.
+int attest_shrink_property(TestConfig* cfg)
+{
+    int budget = ATTEST_PROPERTY_MAX_SHRINKS;
+    int shrinks = 0;
+    bool improved = true;
+
+    while (improved && budget > 0) {
+        improved = false;
+
+        for (int size = 8; size >= 1; size /= 2) {
+            for (int start = 0; start + size <= attest_property.count && budget > 0; budget--) {
+                int count = attest_property.count;
+                memcpy(attest_shrink_backup, attest_choices, sizeof(unsigned long long) * (size_t)count);
+                memmove(attest_choices + start, attest_choices + start + size,
+                    sizeof(unsigned long long) * (size_t)(count - start - size));
+                attest_property.count = count - size;
+
+                if (attest_try_shrink(cfg, count)) {
+                    improved = true;
+                    shrinks++;
+                } else {
+                    start++;
+                }
+            }
+        }
+
+        for (int i = 0; i < attest_property.count && budget > 0; i++) {
+            // `low` is known to pass, `high` to fail, once 0 has failed
+            // to reproduce.
+            unsigned long long low = 0;
+            unsigned long long high = attest_choices[i];
+            unsigned long long candidate = 0;
+
+            while (high > low && budget > 0 && i < attest_property.count) {
+                int count = attest_property.count;
+                memcpy(attest_shrink_backup, attest_choices, sizeof(unsigned long long) * (size_t)count);
+                attest_choices[i] = candidate;
+                budget--;
+
+                if (attest_try_shrink(cfg, count)) {
+                    improved = true;
+                    shrinks++;
+                    high = candidate;
+                } else {
+                    low = candidate;
+                }
+
+                if (high - low <= 1) {
+                    break;
+                }
+                candidate = low + (high - low) / 2;
+            }
+        }
+    }
+
+    return shrinks;
+}
+
+unsigned long long attest_property_seed(const TestConfig* cfg)
+{
+    if (cfg->seed != 0) {
+        return cfg->seed;
+    }
+
+    return attest_mix(attest_context.seed ^ attest_hash_string(cfg->test_title));
+}
+
+// Looks for an input that fails the property, spread over `--jobs`
+// threads. A failure is shrunk and then replayed once more with
+// expectations recording as usual, followed by the seed and inputs.
+void attest_run_property(TestConfig* cfg, int timeout_ms)
+{
+    PropertySearch search = {
+        .cfg = cfg,
+        .seed = attest_property_seed(cfg),
+        .iterations = cfg->iterations > 0 ? cfg->iterations : ATTEST_PROPERTY_ITERATIONS,
+        .thread_count = 1,
+        .next_thread = 0,
+        .checked = false,
+    };
+    search.first_failure = search.iterations;
+
+#ifdef ATTEST_THREADS
+    // The watchdog jumps out of the main thread only, so properties with
+    // a timeout stay on it.
+    int thread_count = attest_context.job_count;
+    if (thread_count > ATTEST_MAX_CASE_THREADS) {
+        thread_count = ATTEST_MAX_CASE_THREADS;
+    }
+    if (thread_count > search.iterations) {
+        thread_count = search.iterations;
+    }
+
+    pthread_t threads[ATTEST_MAX_CASE_THREADS];
+    int started = 0;
+
+    if (timeout_ms == 0 && thread_count > 1) {
+        search.thread_count = thread_count;
+        for (int i = 1; i < thread_count; i++) {
+            if (attest_start_thread(&threads[started], attest_search_property, &search) != 0) {
+                break;
+            }
+            started++;
+        }
+        // Iterations of threads that didn't start go to the main thread.
+        search.thread_count = started + 1;
+    }
+#else
+    (void)timeout_ms;
+#endif
+
+    (void)attest_search_property(&search);
+
+#ifdef ATTEST_THREADS
+    for (int i = 0; i < started; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+#endif
+
+    if (search.first_failure == search.iterations) {
+        if (search.checked) {
+            attest_record_success(cfg);
+        }
+        return;
+    }
+
+    attest_property_probing = true;
+    (void)attest_property_iteration_fails(cfg, search.seed, search.first_failure);
+    int shrinks = attest_shrink_property(cfg);
+    attest_property_probing = false;
+
+    attest_property.inputs_length = 0;
+    attest_property.inputs[0] = '\0';
+    attest_property.describing = true;
+    // The seed and inputs are reported after the replay, so its failures
+    // must not jump out for `.abort_on_failure`.
+    bool abort_armed = attest_abort_armed;
+    attest_abort_armed = false;
+    bool replay_failed = attest_property_fails(cfg, true) || cfg->status == FAILED;
+    attest_abort_armed = abort_armed;
+    attest_property.describing = false;
+
+    FailureInfo failure_info = {
+        .filename = cfg->filename,
+        .line = cfg->line,
+        .verification = "PROPERTY_TEST",
+        .has_msg = true,
+        .has_expected_value = false,
+        .reason = replay_failed
+            ? "Property must hold for every input"
+            : "Property failed once but held when its input was replayed",
+    };
+    // A fixed `.seed` repeats by itself, any other seed through `--seed`.
+    const char* inputs = attest_property.inputs_length > 0 ? attest_property.inputs : "no inputs";
+    if (cfg->seed != 0) {
+        attest_capture_uint(&failure_info.actual, "seed", cfg->seed);
+        (void)snprintf(failure_info.msg, ATTEST_VALUE_BUF, "Iteration %d, shrunk %d times: %.64s",
+            search.first_failure + 1, shrinks, inputs);
+    } else {
+        attest_capture_uint(&failure_info.actual, "seed", attest_context.seed);
+        (void)snprintf(failure_info.msg, ATTEST_VALUE_BUF, "Iteration %d, shrunk %d times: %.64s (repeat with --seed=%llu)",
+            search.first_failure + 1, shrinks, inputs, attest_context.seed);
+    }
+
+    ATTEST_PAUSE_ALLOCS();
+    attest_record_failure(cfg, &failure_info);
+    ATTEST_RESUME_ALLOCS();
+}
+
+// Slot of `key` in the baseline table, or the empty slot it goes to.
+// NULL when the table is full and holds no `key`.
+BaselineEntry* attest_find_baseline(const char* key)
+{
+    size_t slot = attest_hash_string(key) % attest_baseline_slot_count;
+
+    for (size_t step = 0; step < attest_baseline_slot_count; step++) {
+        if (attest_baseline[slot].key == NULL || strcmp(attest_baseline[slot].key, key) == 0) {
+            return &attest_baseline[slot];
+        }
+        slot = (slot + 1) % attest_baseline_slot_count;
+    }
+
+    return NULL;
+}
+
+// Reads the timings of `--baseline=<file>` into an open addressing
+// table keyed by test, or by test and case. A missing file is an error,
+// so a mistyped path can't turn every comparison into a recording.
+void attest_load_baseline(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL) {
+        fprintf(stderr,
+            "%s[ERROR] Unable to open `--baseline` file %s. Pass `--update-baseline` to record it.%s\n",
+            RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    char* text = size >= 0 ? malloc((size_t)size + 1) : NULL;
+
+    if (text == NULL || fseek(file, 0, SEEK_SET) != 0 || fread(text, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "%s[ERROR] Unable to read `--baseline` file %s%s\n", RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    (void)fclose(file);
+    text[size] = '\0';
+    attest_baseline_text = text;
+
+    // The last line may lack its newline. Half of the slots stay empty.
+    size_t line_count = size > 0 && text[size - 1] != '\n';
+    for (long i = 0; i < size; i++) {
+        line_count += text[i] == '\n';
+    }
+
+    attest_baseline_slot_count = line_count * 2 + 1;
+    attest_baseline = calloc(attest_baseline_slot_count, sizeof(BaselineEntry));
+
+    if (attest_baseline == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while loading the baseline.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    int line_number = 0;
+    for (char* line = text; *line != '\0';) {
+        char* line_end = strchr(line, '\n');
+        char* next_line = line_end != NULL ? line_end + 1 : line + strlen(line);
+        line_number++;
+
+        if (line_end != NULL) {
+            *line_end = '\0';
+        }
+
+        if (line[0] == '\0' || line[0] == '#') {
+            line = next_line;
+            continue;
+        }
+
+        char* key = NULL;
+        double ns = strtod(line, &key);
+
+        if (key == line || *key != '\t' || key[1] == '\0' || ns < 0) {
+            fprintf(stderr, "%s[ERROR] Malformed `--baseline` file %s at line %d%s\n", RED, path, line_number, NORMAL);
+            exit(1); // NOLINT
+        }
+
+        key++;
+        BaselineEntry* entry = attest_find_baseline(key);
+        entry->key = key;
+        entry->ns = ns;
+        line = next_line;
+    }
+}
+
+// Path of the file that replaces `path` once a run completes.
+void attest_replacement_path(char* buffer, size_t size, const char* path)
+{
+    int length = snprintf(buffer, size, "%s.new", path);
+
+    if (length < 0 || (size_t)length >= size) {
+        fprintf(stderr, "%s[ERROR] Path %s is too long%s\n", RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+}
+
+// Opens the replacement of the file of `option` with `mode`.
+FILE* attest_reopen_replacement(const char* path, const char* option, const char* mode)
+{
+    char new_path[4096];
+    attest_replacement_path(new_path, sizeof new_path, path);
+
+    FILE* file = fopen(new_path, mode);
+
+    if (file == NULL) {
+        fprintf(stderr, "%s[ERROR] Unable to write `%s` file %s%s\n", RED, option, new_path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    return file;
+}
+
+// Starts an empty replacement of the file of `option`, unbuffered and
+// in append mode, so lines `--jobs` workers write never overlap.
+FILE* attest_open_replacement(const char* path, const char* option)
+{
+    (void)fclose(attest_reopen_replacement(path, option, "w"));
+    FILE* file = attest_reopen_replacement(path, option, "a");
+    (void)setvbuf(file, NULL, _IONBF, 0);
+    return file;
+}
+
+// Text the run wrote to the replacement of the file of `option`.
+char* attest_read_replacement(const char* path, const char* option, size_t* size)
+{
+    char new_path[4096];
+    attest_replacement_path(new_path, sizeof new_path, path);
+
+    FILE* file = fopen(new_path, "rb");
+    char* text = file != NULL ? attest_read_text(file, size) : NULL;
+
+    if (text == NULL) {
+        fprintf(stderr, "%s[ERROR] Unable to read `%s` file %s%s\n", RED, option, new_path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    (void)fclose(file);
+    return text;
+}
+
+// Closes `file` and moves the replacement over the file of `option`.
+void attest_commit_replacement(FILE* file, const char* path, const char* option)
+{
+    char new_path[4096];
+    attest_replacement_path(new_path, sizeof new_path, path);
+
+    if (fclose(file) != 0 || rename(new_path, path) != 0) {
+        fprintf(stderr, "%s[ERROR] Unable to replace `%s` file %s%s\n", RED, option, path, NORMAL);
+        exit(1); // NOLINT
+    }
+}
+
+// Starts a new baseline next to the old one. It replaces the old file
+// once the run completes.
+void attest_open_baseline(const char* path)
+{
+    attest_baseline_out = attest_open_replacement(path, "--baseline");
+    (void)fputs("# attest baseline: wall ns of tests and cases, ns per iteration of benchmarks\n", attest_baseline_out);
+}
+
+void attest_close_baseline(const char* path)
+{
+    attest_commit_replacement(attest_baseline_out, path, "--baseline");
+    attest_baseline_out = NULL;
+}
+
+// Records the time of a passed test, case or benchmark with
+// `--baseline`, or fails it when it got slower than the tolerance.
+// Times below `ATTEST_BASELINE_MIN_US` are mostly noise, so they are
+// only compared for benchmarks.
+void attest_check_baseline(TestConfig* cfg, const char* case_name, double measured_ns)
+{
+    char key[ATTEST_CASE_NAME_SIZE + 1024];
+
+    if (cfg->param_test == NULL) {
+        (void)snprintf(key, sizeof key, "%s", cfg->test_title);
+    } else if (case_name != NULL && case_name[0] != '\0') {
+        (void)snprintf(key, sizeof key, "%s/%s", cfg->test_title, case_name);
+    } else {
+        (void)snprintf(key, sizeof key, "%s/#%d", cfg->test_title, cfg->case_index);
+    }
+
+    if (attest_baseline_out != NULL) {
+        char line[sizeof key + 32];
+        int line_size = snprintf(line, sizeof line, "%.1f\t%s\n", measured_ns, key);
+        if (line_size > 0 && (size_t)line_size < sizeof line) {
+            (void)fwrite(line, 1, (size_t)line_size, attest_baseline_out);
+        }
+        return;
+    }
+
+    if (attest_baseline == NULL) {
+        return;
+    }
+
+    BaselineEntry* entry = attest_find_baseline(key);
+
+    if (entry == NULL || entry->key == NULL) {
+        return;
+    }
+
+    double baseline_ns = entry->ns;
+    long long tolerance = attest_context.baseline_tolerance;
+
+    if ((cfg->benchmark == NULL && baseline_ns < ATTEST_BASELINE_MIN_US * 1000.0)
+        || measured_ns * 100 <= baseline_ns * (double)(100 + tolerance)) {
+        return;
+    }
+
+    FailureInfo failure_info = {
+        .filename = cfg->filename,
+        .line = cfg->line,
+        .verification = "BASELINE",
+        .has_msg = true,
+        .has_expected_value = true,
+        .reason = "Time must stay within the tolerance of the baseline",
+    };
+    attest_capture_ns(&failure_info.actual, "measured", (long long)(measured_ns + 0.5));
+    attest_capture_ns(&failure_info.expected, "baseline", (long long)(baseline_ns + 0.5));
+    (void)snprintf(failure_info.msg, ATTEST_VALUE_BUF,
+        "Took %.0f ns, %.0f%% slower than the baseline of %.0f ns, tolerance is %lld%%",
+        measured_ns,
+        baseline_ns > 0 ? (measured_ns / baseline_ns - 1) * 100 : 100.0,
+        baseline_ns,
+        tolerance);
+
+    if (cfg->param_test != NULL) {
+        attest_record_failure(cfg, &failure_info);
+        return;
+    }
+
+    // Attempts are over, so the failure goes to the last one.
+    FailureInfo* failure_slot = attest_next_attempt_failure(&failed_assertions_per_attempt[test_attempt_count - 1]);
+    if (failure_slot != NULL) {
+        *failure_slot = failure_info;
+    }
+
+    if (test_attempt_count > attest_dirty_attempts) {
+        attest_dirty_attempts = test_attempt_count;
+    }
+
+    cfg->status = FAILED;
+}
+
+// Reads what is left of `file`, terminated by a NUL. Returns NULL when
+// reading fails.
+char* attest_read_text(FILE* file, size_t* size)
+{
+    size_t capacity = 4096;
+    size_t length = 0;
+    char* text = malloc(capacity);
+
+    while (text != NULL) {
+        length += fread(text + length, 1, capacity - length - 1, file);
+
+        if (length < capacity - 1) {
+            break;
+        }
+
+        char* grown = realloc(text, capacity * 2);
+        if (grown == NULL) {
+            free(text);
+            return NULL;
+        }
+        text = grown;
+        capacity *= 2;
+    }
+
+    if (text == NULL || ferror(file)) {
+        free(text);
+        return NULL;
+    }
+
+    text[length] = '\0';
+    *size = length;
+
+    return text;
+}
+
+// Sources match when one path ends with the other, e.g. `src/parse.c`
+// from `git diff --name-only` and `/ci/repo/src/parse.c` from debug
+// info. Leading `./` and `../` are skipped.
+bool attest_same_source(const char* left, const char* right)
+{
+    while (strncmp(left, "./", 2) == 0 || strncmp(left, "../", 3) == 0) {
+        left += left[1] == '/' ? 2 : 3;
+    }
+    while (strncmp(right, "./", 2) == 0 || strncmp(right, "../", 3) == 0) {
+        right += right[1] == '/' ? 2 : 3;
+    }
+
+    size_t left_length = strlen(left);
+    size_t right_length = strlen(right);
+    const char* longer = left_length >= right_length ? left : right;
+    const char* shorter = left_length >= right_length ? right : left;
+    size_t offset = (left_length >= right_length ? left_length : right_length) - strlen(shorter);
+
+    return shorter[0] != '\0'
+        && strcmp(longer + offset, shorter) == 0
+        && (offset == 0 || longer[offset - 1] == '/');
+}
+
+bool attest_source_changed(const char* source)
+{
+    for (int i = 0; i < attest_changed_count; i++) {
+        if (attest_same_source(attest_changed_sources[i], source)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Reads the changed sources of `--affected=<file>`, one per line. `-`
+// reads them from stdin, e.g. piped from `git diff --name-only`.
+void attest_load_affected(const char* path)
+{
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    size_t size = 0;
+    char* text = file != NULL ? attest_read_text(file, &size) : NULL;
+
+    if (text == NULL) {
+        fprintf(stderr, "%s[ERROR] Unable to read `--affected` file %s%s\n", RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    if (file != stdin) {
+        (void)fclose(file);
+    }
+
+    attest_changed_sources = malloc(sizeof(char*) * (size / 2 + 1));
+
+    if (attest_changed_sources == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while loading `--affected`.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    for (char* line = strtok(text, "\r\n"); line != NULL; line = strtok(NULL, "\r\n")) {
+        const char* extension = strrchr(line, '.');
+        attest_changed_sources[attest_changed_count++] = line;
+
+        // Macros and inlined code of a header leave no functions in the
+        // map, so a changed header may affect any test.
+        if (extension != NULL
+            && (strcmp(extension, ".h") == 0 || strcmp(extension, ".hh") == 0 || strcmp(extension, ".hpp") == 0
+                || strcmp(extension, ".hxx") == 0 || strcmp(extension, ".inc") == 0 || strcmp(extension, ".inl") == 0)) {
+            attest_changed_header = true;
+        }
+    }
+}
+
+// Reads `--impact-map=<file>` into an open addressing table keyed by
+// test title. Returns false when the file doesn't exist yet.
+bool attest_load_impact_map(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    size_t size = 0;
+    char* text = attest_read_text(file, &size);
+    (void)fclose(file);
+
+    if (text == NULL) {
+        fprintf(stderr, "%s[ERROR] Unable to read `--impact-map` file %s%s\n", RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    size_t test_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        test_count += text[i] == '\n' && text[i + 1] != '\t' && text[i + 1] != '#';
+    }
+
+    attest_impact_slot_count = test_count * 2 + 1;
+    attest_impact = calloc(attest_impact_slot_count, sizeof(ImpactEntry));
+
+    if (attest_impact == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while loading the impact map.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    // A test line is `title<TAB>file`, followed by its source lines.
+    for (char* line = text; *line != '\0';) {
+        char* line_end = strchr(line, '\n');
+        char* next_line = line_end != NULL ? line_end + 1 : line + strlen(line);
+
+        if (line[0] != '\t' && line[0] != '#' && line[0] != '\n') {
+            char* title_end = strchr(line, '\t');
+            if (title_end == NULL || (line_end != NULL && title_end > line_end)) {
+                fprintf(stderr, "%s[ERROR] Malformed `--impact-map` file %s%s\n", RED, path, NORMAL);
+                exit(1); // NOLINT
+            }
+            *title_end = '\0';
+
+            size_t slot = attest_hash_string(line) % attest_impact_slot_count;
+            while (attest_impact[slot].title != NULL && strcmp(attest_impact[slot].title, line) != 0) {
+                slot = (slot + 1) % attest_impact_slot_count;
+            }
+            attest_impact[slot].title = line;
+            attest_impact[slot].sources = next_line;
+        }
+
+        line = next_line;
+    }
+
+    return true;
+}
+
+// Tests missing from the map are new or crashed while it was recorded,
+// so they run like tests whose own file or sources changed.
+bool attest_is_affected(const TestConfig* cfg)
+{
+    if (attest_changed_header || attest_source_changed(cfg->filename)) {
+        return true;
+    }
+
+    size_t slot = attest_hash_string(cfg->test_title) % attest_impact_slot_count;
+    while (attest_impact[slot].title != NULL && strcmp(attest_impact[slot].title, cfg->test_title) != 0) {
+        slot = (slot + 1) % attest_impact_slot_count;
+    }
+
+    if (attest_impact[slot].title == NULL) {
+        return true;
+    }
+
+    // Source lines are `<TAB>source<TAB>functions`, or `<TAB>*` for a
+    // test that depends on everything.
+    char source[4096];
+    for (const char* line = attest_impact[slot].sources; line[0] == '\t'; line = strchr(line, '\n') + 1) {
+        size_t length = strcspn(line + 1, "\t\n");
+
+        if (length == 1 && line[1] == '*') {
+            return true;
+        }
+
+        if (length < sizeof source) {
+            memcpy(source, line + 1, length);
+            source[length] = '\0';
+            if (attest_source_changed(source)) {
+                return true;
+            }
+        }
+
+        if (strchr(line, '\n') == NULL) {
+            break;
+        }
+    }
+
+    return false;
+}
+
+#ifdef ATTEST_IMPACT
+// Called on entry of every function built with -finstrument-functions.
+// Each function is added once per test to a lock free set, which
+// threads of the test share.
+void __attribute__((no_instrument_function)) __cyg_profile_func_enter(void* function, void* call_site)
+{
+    char* address = function;
+    size_t slot_count = ATTEST_IMPACT_MAX_FUNCTIONS * 2;
+    (void)call_site;
+
+    if (!__atomic_load_n(&attest_impact_recording, __ATOMIC_ACQUIRE)
+        || address < __executable_start || address >= etext) {
+        return;
+    }
+
+    size_t key = (size_t)(address - attest_impact_base) + 1;
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) % slot_count;
+
+    for (;;) {
+        size_t seen = __atomic_load_n(&attest_impact_slots[slot], __ATOMIC_RELAXED);
+
+        if (seen == key) {
+            return;
+        }
+
+        if (seen == 0) {
+            // Past the limit the test is recorded as depending on
+            // everything, so the set never fills up.
+            if (__atomic_fetch_add(&attest_impact_used, 1, __ATOMIC_RELAXED) >= ATTEST_IMPACT_MAX_FUNCTIONS) {
+                return;
+            }
+
+            if (__atomic_compare_exchange_n(&attest_impact_slots[slot], &seen, key,
+                    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return;
+            }
+
+            (void)__atomic_fetch_sub(&attest_impact_used, 1, __ATOMIC_RELAXED);
+            if (seen == key) {
+                return;
+            }
+        }
+
+        slot = (slot + 1) % slot_count;
+    }
+}
+
+void __attribute__((no_instrument_function)) __cyg_profile_func_exit(void* function, void* call_site)
+{
+    (void)function;
+    (void)call_site;
+}
+#endif
+
+void attest_begin_impact(void)
+{
+#ifdef ATTEST_IMPACT
+    if (attest_impact_out == NULL) {
+        return;
+    }
+
+    if (__atomic_load_n(&attest_impact_used, __ATOMIC_RELAXED) != 0) {
+        memset(attest_impact_slots, 0, sizeof attest_impact_slots);
+        __atomic_store_n(&attest_impact_used, 0, __ATOMIC_RELAXED);
+    }
+    // Threads of the test read the flag, so the cleared set is published
+    // with it.
+    __atomic_store_n(&attest_impact_recording, true, __ATOMIC_RELEASE);
+#endif
+}
+
+// Appends the functions the test entered as `title<TAB>file<TAB>offset...`
+// in hex. They are resolved to sources once the run completes. A NULL
+// test stops recording without a record.
+void attest_end_impact(const TestConfig* cfg)
+{
+#ifdef ATTEST_IMPACT
+    if (!__atomic_load_n(&attest_impact_recording, __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_store_n(&attest_impact_recording, false, __ATOMIC_RELEASE);
+
+    if (cfg == NULL) {
+        return;
+    }
+
+    size_t capacity = strlen(cfg->test_title) + strlen(cfg->filename) + 8
+        + (size_t)ATTEST_IMPACT_MAX_FUNCTIONS * (sizeof(size_t) * 2 + 1);
+    ATTEST_PAUSE_ALLOCS();
+    char* line = malloc(capacity);
+    ATTEST_RESUME_ALLOCS();
+
+    if (line == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while recording the impact map.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    size_t length = (size_t)snprintf(line, capacity, "%s\t%s", cfg->test_title, cfg->filename);
+
+    if (__atomic_load_n(&attest_impact_used, __ATOMIC_RELAXED) >= ATTEST_IMPACT_MAX_FUNCTIONS) {
+        length += (size_t)snprintf(line + length, capacity - length, "\t*");
+    } else {
+        for (size_t i = 0; i < sizeof attest_impact_slots / sizeof attest_impact_slots[0]; i++) {
+            if (attest_impact_slots[i] != 0) {
+                length += (size_t)snprintf(line + length, capacity - length, "\t%zx", attest_impact_slots[i] - 1);
+            }
+        }
+    }
+    line[length++] = '\n';
+
+    (void)fwrite(line, 1, length, attest_impact_out);
+    ATTEST_PAUSE_ALLOCS();
+    free(line);
+    ATTEST_RESUME_ALLOCS();
+#else
+    (void)cfg;
+#endif
+}
+
+#ifdef ATTEST_IMPACT
+// Records are collected next to the old map, which they replace once
+// the run completes.
+void attest_open_impact_map(const char* path)
+{
+    attest_impact_out = attest_open_replacement(path, "--impact-map");
+
+    // Offsets into a position independent executable are the addresses
+    // its debug info uses. Other executables are loaded where they were
+    // linked. `e_type` of the ELF header tells them apart.
+    unsigned char* header = (unsigned char*)__executable_start;
+    int type = header[5] == 1 ? header[16] | header[17] << 8 : header[17] | header[16] << 8;
+    attest_impact_base = type == 3 ? __executable_start : NULL;
+}
+
+int attest_compare_offsets(const void* left, const void* right)
+{
+    size_t left_offset = ((const ImpactFunction*)left)->offset;
+    size_t right_offset = ((const ImpactFunction*)right)->offset;
+
+    return (left_offset > right_offset) - (left_offset < right_offset);
+}
+
+int attest_compare_sources(const void* left, const void* right)
+{
+    const ImpactFunction* left_function = *(const ImpactFunction* const*)left;
+    const ImpactFunction* right_function = *(const ImpactFunction* const*)right;
+    int order = strcmp(left_function->source, right_function->source);
+
+    return order != 0 ? order : strcmp(left_function->function, right_function->function);
+}
+
+char* attest_copy_line(const char* line)
+{
+    size_t length = strcspn(line, "\r\n");
+    char* copy = malloc(length + 1);
+
+    if (copy != NULL) {
+        memcpy(copy, line, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+// Looks up the function and source of each offset with one run of
+// `ATTEST_ADDR2LINE`. Unknown ones are left as "??".
+void attest_resolve_functions(ImpactFunction* functions, size_t count)
+{
+    char executable[4096];
+    ssize_t executable_length = readlink("/proc/self/exe", executable, sizeof executable - 1);
+    FILE* addresses = tmpfile();
+    int output[2];
+
+    if (executable_length <= 0 || addresses == NULL || pipe(output) != 0) {
+        fprintf(stderr, "%s[ERROR] Unable to resolve functions for `--impact-map`.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+    executable[executable_length] = '\0';
+
+    for (size_t i = 0; i < count; i++) {
+        (void)fprintf(addresses, "%zx\n", functions[i].offset);
+    }
+    (void)fflush(addresses);
+    (void)lseek(fileno(addresses), 0, SEEK_SET);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        (void)dup2(fileno(addresses), STDIN_FILENO);
+        (void)dup2(output[1], STDOUT_FILENO);
+        (void)close(output[0]);
+        (void)execlp(ATTEST_ADDR2LINE, ATTEST_ADDR2LINE, "-f", "-e", executable, (char*)NULL);
+        _exit(127);
+    }
+    (void)close(output[1]);
+
+    // Two lines per address: the function, then `source:line`.
+    FILE* resolved = pid > 0 ? fdopen(output[0], "r") : NULL;
+    char line[4096];
+    size_t resolved_count = 0;
+
+    while (resolved != NULL && resolved_count < count && fgets(line, sizeof line, resolved) != NULL) {
+        functions[resolved_count].function = attest_copy_line(line);
+
+        if (fgets(line, sizeof line, resolved) == NULL) {
+            break;
+        }
+
+        char* line_number = strrchr(line, ':');
+        if (line_number != NULL) {
+            *line_number = '\0';
+        }
+        functions[resolved_count].source = attest_copy_line(line);
+
+        if (functions[resolved_count].function == NULL || functions[resolved_count].source == NULL) {
+            fprintf(stderr, "%s[ATTEST ERROR] Out of memory while writing the impact map.%s\n", RED, NORMAL);
+            exit(1); // NOLINT
+        }
+        resolved_count++;
+    }
+
+    int status = 0;
+    if (resolved != NULL) {
+        (void)fclose(resolved);
+    }
+    if (pid > 0) {
+        (void)waitpid(pid, &status, 0);
+    }
+    (void)fclose(addresses);
+
+    if (pid <= 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || resolved_count < count) {
+        fprintf(stderr, "%s[ERROR] Unable to run `%s` for `--impact-map`.%s\n", RED, ATTEST_ADDR2LINE, NORMAL);
+        exit(1); // NOLINT
+    }
+}
+
+// Writes the map as `title<TAB>file` lines, each followed by lines of
+// `<TAB>source<TAB>functions` for the sources the test entered. The test
+// file always counts, so its functions and those of Attest are left
+// out. A test with functions of unknown source, e.g. built without -g,
+// is marked with `<TAB>*` to run on every change.
+void attest_close_impact_map(const char* path)
+{
+    (void)fclose(attest_impact_out);
+    attest_impact_out = NULL;
+
+    size_t size = 0;
+    char* records = attest_read_replacement(path, "--impact-map", &size);
+
+    size_t field_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        field_count += records[i] == '\t';
+    }
+
+    ImpactFunction* functions = calloc(field_count + 1, sizeof(ImpactFunction));
+    const ImpactFunction** entered = calloc(field_count + 1, sizeof(ImpactFunction*));
+
+    if (functions == NULL || entered == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while writing the impact map.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    // Every offset once, in order, so records look them up by bisection.
+    size_t function_count = 0;
+    bool any_overflow = false;
+    for (char* line = records; *line != '\0'; line = strchr(line, '\n') + 1) {
+        char* field = strpbrk(line, "\t\n");
+        field = field != NULL && *field == '\t' ? strpbrk(field + 1, "\t\n") : NULL;
+        any_overflow = any_overflow || (field != NULL && field[0] == '\t' && field[1] == '*');
+
+        for (; field != NULL && *field == '\t' && field[1] != '*'; field = strpbrk(field + 1, "\t\n")) {
+            functions[function_count++].offset = (size_t)strtoull(field + 1, NULL, 16);
+        }
+
+        if (strchr(line, '\n') == NULL) {
+            break;
+        }
+    }
+
+    qsort(functions, function_count, sizeof(ImpactFunction), attest_compare_offsets);
+    size_t unique_count = 0;
+    for (size_t i = 0; i < function_count; i++) {
+        if (unique_count == 0 || functions[unique_count - 1].offset != functions[i].offset) {
+            functions[unique_count++] = functions[i];
+        }
+    }
+
+    // A map without any function would skip every test on a change.
+    if (unique_count == 0 && size > 0 && !any_overflow) {
+        fprintf(stderr,
+            "%s[ERROR] No function was entered for `--impact-map`. Build the tests and code under test with `-finstrument-functions`.%s\n",
+            RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    if (unique_count > 0) {
+        attest_resolve_functions(functions, unique_count);
+    }
+
+    FILE* file = attest_reopen_replacement(path, "--impact-map", "w");
+    (void)fputs("# attest impact map: sources and functions each test entered\n", file);
+
+    for (char* line = records; *line != '\0';) {
+        char* line_end = strchr(line, '\n');
+        char* title_end = strchr(line, '\t');
+        char* file_end = title_end != NULL ? strpbrk(title_end + 1, "\t\n") : NULL;
+
+        if (line_end == NULL || file_end == NULL) {
+            break;
+        }
+
+        bool depends_on_everything = file_end[0] == '\t' && file_end[1] == '*';
+        size_t entered_count = 0;
+
+        for (char* field = file_end; !depends_on_everything && *field == '\t'; field = strpbrk(field + 1, "\t\n")) {
+            ImpactFunction key = { .offset = (size_t)strtoull(field + 1, NULL, 16) };
+            const ImpactFunction* function = bsearch(
+                &key, functions, unique_count, sizeof(ImpactFunction), attest_compare_offsets);
+
+            // An offset nothing resolved, say from an edited record, could
+            // be anywhere.
+            if (function == NULL) {
+                depends_on_everything = true;
+                break;
+            }
+
+            size_t source_length = strlen(function->source);
+            char test_file[4096];
+            (void)snprintf(test_file, sizeof test_file, "%.*s", (int)(file_end - title_end - 1), title_end + 1);
+
+            if ((source_length >= 8 && strcmp(function->source + source_length - 8, "attest.h") == 0)
+                || attest_same_source(function->source, test_file)) {
+                continue;
+            }
+
+            if (strcmp(function->source, "??") == 0) {
+                depends_on_everything = true;
+            }
+            entered[entered_count++] = function;
+        }
+
+        (void)fprintf(file, "%.*s\t%.*s\n",
+            (int)(title_end - line), line, (int)(file_end - title_end - 1), title_end + 1);
+
+        if (depends_on_everything) {
+            (void)fputs("\t*\n", file);
+        } else {
+            qsort(entered, entered_count, sizeof(ImpactFunction*), attest_compare_sources);
+            for (size_t i = 0; i < entered_count; i++) {
+                if (i > 0 && strcmp(entered[i - 1]->source, entered[i]->source) == 0) {
+                    (void)fprintf(file, " %s", entered[i]->function);
+                } else {
+                    (void)fprintf(file, "%s\t%s\t%s", i > 0 ? "\n" : "", entered[i]->source, entered[i]->function);
+                }
+            }
+            if (entered_count > 0) {
+                (void)fputc('\n', file);
+            }
+        }
+
+        line = line_end + 1;
+    }
+
+    for (size_t i = 0; i < unique_count; i++) {
+        free((char*)functions[i].function);
+        free((char*)functions[i].source);
+    }
+    free(functions);
+    free(entered);
+    free(records);
+
+    attest_commit_replacement(file, path, "--impact-map");
+}
+#endif
+
+// Reads `--history=<file>` into an open addressing table keyed by test
+// title. Lines are `title<TAB>runs`, where each run is
+// `<outcome><attempts>/<wall us>`. Outcomes are `p` passed, `r` passed
+// after a retry, `f` failed, `t` timed out, `c` crashed and `m` without
+// expectations. A missing file leaves the table empty.
+void attest_load_history(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return;
+    }
+
+    size_t size = 0;
+    char* text = attest_read_text(file, &size);
+    (void)fclose(file);
+
+    if (text == NULL) {
+        fprintf(stderr, "%s[ERROR] Unable to read `--history` file %s%s\n", RED, path, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    size_t line_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        line_count += text[i] == '\n';
+    }
+
+    attest_history_slot_count = line_count * 2 + 2;
+    attest_history = calloc(attest_history_slot_count, sizeof(HistoryEntry));
+
+    if (attest_history == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while loading the history.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    int line_number = 0;
+    int entry_count = 0;
+    for (char* line = text; *line != '\0';) {
+        char* line_end = strchr(line, '\n');
+        char* next_line = line_end != NULL ? line_end + 1 : line + strlen(line);
+        line_number++;
+
+        if (line_end != NULL) {
+            *line_end = '\0';
+        }
+
+        if (line[0] == '\0' || line[0] == '#') {
+            line = next_line;
+            continue;
+        }
+
+        char* runs = strchr(line, '\t');
+
+        if (runs == NULL || runs == line) {
+            fprintf(stderr, "%s[ERROR] Malformed `--history` file %s at line %d%s\n", RED, path, line_number, NORMAL);
+            exit(1); // NOLINT
+        }
+
+        *runs = '\0';
+        size_t slot = attest_hash_string(line) % attest_history_slot_count;
+        while (attest_history[slot].title != NULL && strcmp(attest_history[slot].title, line) != 0) {
+            slot = (slot + 1) % attest_history_slot_count;
+        }
+
+        attest_history[slot].title = line;
+        attest_history[slot].runs = runs + 1;
+        entry_count++;
+        line = next_line;
+    }
+
+    // Entries point into the text, so it is kept unless there are none.
+    if (entry_count == 0) {
+        free(text);
+    }
+}
+
+HistoryEntry* attest_find_history(const char* title)
+{
+    if (attest_history == NULL) {
+        return NULL;
+    }
+
+    size_t slot = attest_hash_string(title) % attest_history_slot_count;
+    while (attest_history[slot].title != NULL && strcmp(attest_history[slot].title, title) != 0) {
+        slot = (slot + 1) % attest_history_slot_count;
+    }
+
+    return attest_history[slot].title != NULL ? &attest_history[slot] : NULL;
+}
+
+// A run is flaky when it passed only after a retry, or when it failed
+// between two passed runs.
+void attest_history_flakiness(const char* runs, int* flaky_runs, int* run_count)
+{
+    char before_previous = 0;
+    char previous = 0;
+    *flaky_runs = 0;
+    *run_count = 0;
+
+    for (const char* run = runs; *run != '\0' && *run != '\n';) {
+        char outcome = *run;
+        bool passed = outcome == 'p' || outcome == 'r';
+        bool previous_failed = previous == 'f' || previous == 't';
+        bool before_previous_passed = before_previous == 'p' || before_previous == 'r';
+
+        *run_count += 1;
+        *flaky_runs += outcome == 'r' || (passed && previous_failed && before_previous_passed);
+
+        before_previous = previous;
+        previous = outcome;
+
+        run = strpbrk(run, " \n");
+        if (run == NULL || *run == '\n') {
+            break;
+        }
+        run++;
+    }
+}
+
+// Retries are kept for tests known to be flaky, and for tests without
+// history so their flakiness can show.
+bool attest_history_allows_retries(const char* title)
+{
+    HistoryEntry* entry = attest_find_history(title);
+    int flaky_runs = 0;
+    int run_count = 0;
+
+    if (entry == NULL) {
+        return true;
+    }
+
+    attest_history_flakiness(entry->runs, &flaky_runs, &run_count);
+
+    return flaky_runs > 0;
+}
+
+// Outcome of the test that just ran, as `--history` records it.
+char attest_history_outcome(const TestConfig* cfg)
+{
+    Status status = cfg->status;
+
+    if (cfg->param_test_runner != NULL && status != CRASHED && case_count > 0) {
+        status = any_instance(TIMED_OUT)   ? TIMED_OUT
+            : any_instance(FAILED)         ? FAILED
+            : any_instance(MISSING_EXPECTATION) ? MISSING_EXPECTATION
+                                           : PASSED;
+    }
+
+    switch (status) {
+    case PASSED:
+        if (cfg->param_test_runner != NULL) {
+            return __atomic_load_n(&attest_case_retried, __ATOMIC_RELAXED) ? 'r' : 'p';
+        }
+        return test_attempt_count > 1 ? 'r' : 'p';
+    case FAILED:
+        return 'f';
+    case TIMED_OUT:
+        return 't';
+    case CRASHED:
+        return 'c';
+    default:
+        return 'm';
+    }
+}
+
+// Appends the runs of `cfg` with this one to the new history, dropping
+// the oldest past `ATTEST_HISTORY_RUNS`.
+void attest_record_history(const TestConfig* cfg, char outcome, int attempts)
+{
+    if (attest_history_out == NULL || cfg->skip) {
+        return;
+    }
+
+    HistoryEntry* entry = attest_find_history(cfg->test_title);
+    const char* kept = entry != NULL ? entry->runs : "";
+    int flaky_runs = 0;
+    int run_count = 0;
+    attest_history_flakiness(kept, &flaky_runs, &run_count);
+
+    for (; run_count >= ATTEST_HISTORY_RUNS && *kept != '\0'; run_count--) {
+        const char* next = strchr(kept, ' ');
+        kept = next != NULL ? next + 1 : "";
+    }
+
+    size_t capacity = strlen(cfg->test_title) + strlen(kept) + 64;
+    ATTEST_PAUSE_ALLOCS();
+    char* line = malloc(capacity);
+    ATTEST_RESUME_ALLOCS();
+
+    if (line == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while recording the history.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    int length = snprintf(line, capacity, "%s\t%s%s%c%d/%lld\n",
+        cfg->test_title, kept, *kept != '\0' ? " " : "",
+        outcome, attempts > 0 ? attempts : 1, cfg->wall_ns / 1000);
+
+    if (length > 0 && (size_t)length < capacity) {
+        (void)fwrite(line, 1, (size_t)length, attest_history_out);
+    }
+
+    ATTEST_PAUSE_ALLOCS();
+    free(line);
+    ATTEST_RESUME_ALLOCS();
+}
+
+// The new history replaces the old one once the run completes, like
+// the baseline does.
+void attest_open_history(const char* path)
+{
+    attest_history_out = attest_open_replacement(path, "--history");
+    (void)fputs("# attest history: recent runs of each test, oldest first, as <outcome><attempts>/<wall us>\n", attest_history_out);
+}
+
+// Tests that didn't run this time keep their old runs. Tests that ran
+// and had flaky runs go to the summary.
+void attest_close_history(const char* path)
+{
+    (void)fclose(attest_history_out);
+    attest_history_out = NULL;
+
+    size_t size = 0;
+    char* text = attest_read_replacement(path, "--history", &size);
+
+    size_t line_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        line_count += text[i] == '\n';
+    }
+
+    attest_flaky = calloc(line_count + 1, sizeof(FlakyRecord));
+
+    if (attest_flaky == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while writing the history.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    for (char* line = text; *line != '\0';) {
+        char* line_end = strchr(line, '\n');
+        char* runs = strchr(line, '\t');
+
+        if (line_end == NULL) {
+            break;
+        }
+        *line_end = '\0';
+
+        if (line[0] != '#' && runs != NULL) {
+            *runs = '\0';
+
+            HistoryEntry* entry = attest_find_history(line);
+            if (entry != NULL) {
+                entry->written = true;
+            }
+
+            FlakyRecord record = { .title = line };
+            attest_history_flakiness(runs + 1, &record.flaky_runs, &record.run_count);
+            if (record.flaky_runs > 0) {
+                attest_flaky[attest_flaky_count++] = record;
+            }
+        }
+
+        line = line_end + 1;
+    }
+
+    // Titles of flaky tests point into the text, so it stays around
+    // for the summary.
+    if (attest_flaky_count == 0) {
+        free(text);
+    }
+
+    FILE* file = attest_reopen_replacement(path, "--history", "a");
+
+    for (size_t i = 0; i < attest_history_slot_count; i++) {
+        if (attest_history[i].title != NULL && !attest_history[i].written) {
+            (void)fprintf(file, "%s\t%s\n", attest_history[i].title, attest_history[i].runs);
+        }
+    }
+
+    attest_commit_replacement(file, path, "--history");
+}
+
+typedef struct
+{
+    unsigned long long key;
+    TestConfig* test;
+} ShuffledTest;
+
+int attest_compare_shuffled(const void* left, const void* right)
+{
+    const ShuffledTest* left_test = left;
+    const ShuffledTest* right_test = right;
+
+    if (left_test->key != right_test->key) {
+        return left_test->key < right_test->key ? -1 : 1;
+    }
+
+    return strcmp(left_test->test->test_title, right_test->test->test_title);
+}
+
+// Orders tests by a hash of the seed and their title. A test's place
+// relative to another only depends on the seed, so a failing order
+// still repeats with `--filter` narrowing it down.
+void attest_shuffle_tests(TestConfig** selected_tests, int selected_count)
+{
+    ShuffledTest* shuffled = malloc(sizeof(ShuffledTest) * (size_t)(selected_count + 1));
+
+    if (shuffled == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while shuffling tests.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    for (int i = 0; i < selected_count; i++) {
+        shuffled[i].key = attest_mix(attest_context.shuffle_seed ^ attest_hash_string(selected_tests[i]->test_title));
+        shuffled[i].test = selected_tests[i];
+    }
+
+    qsort(shuffled, (size_t)selected_count, sizeof(ShuffledTest), attest_compare_shuffled);
+
+    for (int i = 0; i < selected_count; i++) {
+        selected_tests[i] = shuffled[i].test;
+    }
+
+    free(shuffled);
+}
+
+// Moves tests whose last run didn't pass, and tests without a history
+// yet, to the front, keeping the order within both groups.
+void attest_order_failed_first(TestConfig** selected_tests, int selected_count)
+{
+    TestConfig** passed_tests = malloc(sizeof(TestConfig*) * (size_t)(selected_count + 1));
+    int failed_count = 0;
+    int passed_count = 0;
+
+    if (passed_tests == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while ordering tests.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    for (int i = 0; i < selected_count; i++) {
+        HistoryEntry* entry = attest_find_history(selected_tests[i]->test_title);
+        const char* last_run = entry != NULL ? strrchr(entry->runs, ' ') : NULL;
+        last_run = last_run != NULL ? last_run + 1 : (entry != NULL ? entry->runs : "n");
+
+        if (last_run[0] != 'p' && last_run[0] != 'r') {
+            selected_tests[failed_count++] = selected_tests[i];
+        } else {
+            passed_tests[passed_count++] = selected_tests[i];
+        }
+    }
+
+    memcpy(selected_tests + failed_count, passed_tests, sizeof(TestConfig*) * (size_t)passed_count);
+    free(passed_tests);
+}
+
+// A jump out of a property body skips the code that ends its search or
+// replay, so the expectations of later tests would still only be noted.
+void attest_leave_property(void)
+{
+    attest_property_probing = false;
+    attest_property.describing = false;
+    attest_first_success_pending = true;
+}
+
+// Runs the test body of one attempt. Returns true when the body ran
+// past its timeout. The watchdog is only armed for tests with a
+// timeout, so other tests pay nothing for it.
+bool attest_run_test_body(TestConfig* cfg, TestContext* context, int timeout_ms)
+{
+#ifdef ATTEST_POSIX
+    if (timeout_ms > 0) {
+        if (sigsetjmp(attest_timeout_jump, 1) != 0) {
+            attest_abort_armed = false;
+            attest_leave_property();
+            return true;
+        }
+        attest_arm_watchdog(timeout_ms);
+    }
+#else
+    (void)timeout_ms;
+#endif
+
+    if (cfg->abort_on_failure) {
+        if (setjmp(attest_abort_jump) != 0) {
+            attest_leave_property();
+#ifdef ATTEST_POSIX
+            if (timeout_ms > 0) {
+                attest_disarm_watchdog();
+            }
+#endif
+            return false;
+        }
+        attest_abort_armed = true;
+    }
+
+    if (cfg->contextual_test) {
+        cfg->contextual_test(context);
+    } else if (cfg->simple_test) {
+        cfg->simple_test();
+    } else if (cfg->param_test) {
+        cfg->param_test(cfg);
+    } else if (cfg->benchmark) {
+        attest_measure_bench(cfg, context);
+    } else if (cfg->property) {
+        attest_run_property(cfg, timeout_ms);
+    } else {
+        (void)fprintf(stderr, "%s[ERROR] Attest entered invalid state. capture debug logs and file issue.%s\n", RED, NORMAL);
+        exit(1);
+    }
+
+    attest_abort_armed = false;
+
+#ifdef ATTEST_POSIX
+    if (timeout_ms > 0) {
+        attest_disarm_watchdog();
+    }
+#endif
+
+    return false;
+}
+
+void attester()
+{
+    if (attest_internal_current_test == NULL) {
+        fprintf(stderr, "[Attest Error] Reach unreachable state");
+        exit(1);
+    }
+
+    TestConfig* cfg = attest_internal_current_test;
+
+    bool is_param_test = cfg->param_test != NULL;
+
+    if (cfg->skip) {
+        skip_count += 1;
+        return;
+    }
+
+    // `--history` runs tests it hasn't seen being flaky once. Cases share
+    // the verdict of their test.
+    bool retries = is_param_test ? attest_case_retries : attest_history_allows_retries(cfg->test_title);
+    int attempts = retries || cfg->attempts <= 1 ? cfg->attempts : 0;
+
+    test_attempt_count = 0;
+    int max_attempts = attempts ? attempts : 1;
+    int timeout_ms = cfg->timeout_ms ? cfg->timeout_ms : attest_context.timeout_ms;
+    Status statuses[ATTEST_MAX_TEST_ATTEMPTS];
+
+    cfg->wall_ns = 0;
+    cfg->cpu_ns = 0;
+
+    for (
+        cfg->attempt_count = 0;
+        cfg->attempt_count < max_attempts;
+        cfg->attempt_count++) {
+        AttestClock attempt_start = attest_clock_now();
+        cfg->status = MISSING_EXPECTATION;
+        attest_first_success_pending = true;
+
+        TestContext context = {
+            .all = NULL,
+            .each = NULL,
+            .self = NULL
+        };
+
+        global_param_context.self = NULL;
+
+#ifdef ATTEST_TRACK_ALLOCS
+        // Threads share the counters, so cases on a pool are not measured.
+        AllocMark alloc_start = attest_begin_alloc_window();
+#endif
+#ifdef ATTEST_PERF_COUNTERS
+        PerfStats perf_start = attest_perf_read();
+#endif
+
+        if (attest_context.global_shared_data != NULL) {
+            context.all = attest_context.global_shared_data;
+        }
+
+        if (attest_before_each_handler != NULL && !is_param_test) {
+            attest_before_each_handler(&context);
+        }
+
+        if (is_param_test && cfg->before) {
+            (void)fprintf(stderr, "%s[ERROR] Use `before_each_case` instead of `before_each` for paramerterize tests.%s\n", RED, NORMAL);
+            exit(1);
+        }
+
+        if (cfg->before) {
+            cfg->before(&context);
+        }
+
+        if (cfg->before_each_case) {
+            cfg->before_each_case(&global_param_context);
+        }
+
+#ifdef ATTEST_THREADS
+        if (!attest_case_thread) {
+            __atomic_store_n(&attest_shared_test, cfg, __ATOMIC_RELEASE);
+        }
+#endif
+
+        bool timed_out = attest_run_test_body(cfg, &context, timeout_ms);
+
+#ifdef ATTEST_THREADS
+        if (!attest_case_thread) {
+            __atomic_store_n(&attest_shared_test, NULL, __ATOMIC_RELEASE);
+            attest_merge_thread_failures(cfg);
+        }
+#endif
+
+        if (timed_out) {
+            cfg->status = TIMED_OUT;
+        }
+
+        if (is_param_test && cfg->after) {
+            (void)fprintf(stderr, "%s[ERROR] Use `after_each_case` instead of `after_each` for paramerterize tests.%s\n", RED, NORMAL);
+            exit(1);
+        }
+
+        if (cfg->after) {
+            cfg->after(&context);
+        }
+
+
+        if (cfg->after_each_case) {
+            cfg->after_each_case(&global_param_context);
+        }
+
+        if (attest_after_each_handler != NULL) {
+            attest_after_each_handler(&context);
+        }
+
+#ifdef ATTEST_TRACK_ALLOCS
+        if (!attest_case_thread) {
+            attest_end_alloc_window(cfg, alloc_start);
+        }
+#else
+        if (cfg->check_leaks) {
+            (void)fprintf(stderr, "%s[ERROR] Define `ATTEST_TRACK_ALLOCS` before including attest.h to use `.check_leaks`.%s\n", RED, NORMAL);
+            exit(1);
+        }
+#endif
+#ifdef ATTEST_PERF_COUNTERS
+        cfg->perf_stats = attest_perf_since(perf_start);
+#endif
+
+        AttestClock attempt_duration = attest_clock_since(attempt_start);
+        cfg->wall_ns += attempt_duration.wall_ns;
+        cfg->cpu_ns += attempt_duration.cpu_ns;
+
+        // Cases of a parallel test finish in any order so they stay quiet.
+        if (attempts > 0 && cfg->status == PASSED && !cfg->parallel_cases) {
+            attest_print(
+                "%s ->%s %sAttempt %d:%s %sPassed%s\n",
+                GRAY, NORMAL, CYAN,
+                cfg->attempt_count + 1,
+                NORMAL,
+                GREEN,
+                NORMAL);
+        }
+
+        statuses[test_attempt_count] = cfg->status;
+        test_attempt_count++;
+        if (cfg->status == PASSED || cfg->status == MISSING_EXPECTATION) {
+            break;
+        }
+    }
+
+    // Case fixtures live across the attempts of their case.
+    if (is_param_test) {
+        attest_teardown_case_fixtures();
+    }
+
+    // Expectations outside of a test take the slow path and hit its error.
+    attest_first_success_pending = true;
+
+    // A case that passes on a retry passes like a retried test does.
+    if (is_param_test && cfg->status == PASSED && test_attempt_count > 1) {
+        InstanceResult* case_result = &parameterize_instance_results[cfg->param_index];
+        case_result->status = PASSED;
+        case_result->failure_count = 0;
+        __atomic_store_n(&attest_case_retried, true, __ATOMIC_RELAXED);
+    }
+
+    if (test_attempt_count > max_attempts) {
+        fprintf(stderr, "%s[ATTEST ERROR] Reach invalid state concerning test attempts. Print debug logs and file issue.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    if (is_param_test && cfg->status == MISSING_EXPECTATION) {
+        InstanceResult* case_result = &parameterize_instance_results[cfg->param_index];
+        case_result->has_status = false;
+        case_result->status = MISSING_EXPECTATION;
+    }
+
+    if (is_param_test && cfg->status == TIMED_OUT) {
+        InstanceResult* case_result = &parameterize_instance_results[cfg->param_index];
+        case_result->has_status = true;
+        case_result->case_name = global_param_context.case_name;
+        case_result->status = TIMED_OUT;
+    }
+
+    if (is_param_test) {
+        InstanceResult* case_result = &parameterize_instance_results[cfg->param_index];
+        case_result->wall_ns = cfg->wall_ns;
+        case_result->cpu_ns = cfg->cpu_ns;
+        case_result->perf_stats = cfg->perf_stats;
+
+        if (cfg->status == PASSED && attest_context.baseline_path != NULL) {
+            attest_check_baseline(cfg, global_param_context.case_name, (double)cfg->wall_ns);
+        }
+        return;
+    }
+
+    bool an_attempt_is_missing_verification = has_status(
+        MISSING_EXPECTATION,
+        statuses,
+        test_attempt_count);
+
+    if (an_attempt_is_missing_verification) {
+        cfg->status = MISSING_EXPECTATION;
+    }
+
+    if (cfg->status == PASSED && attest_context.baseline_path != NULL) {
+        attest_check_baseline(cfg, NULL, cfg->benchmark ? cfg->bench_stats.mean_ns : (double)cfg->wall_ns);
+    }
+
+    switch (cfg->status) {
+    case PASSED:
+        pass_count++;
+        if (cfg->benchmark) {
+            BenchStats* stats = &cfg->bench_stats;
+            attest_print(
+                "%s[BENCH]%s %s%s%s %s%.1f ns/op%s %s(median %.1f, p99 %.1f, stddev %.1f, %d x %lld)%s\n",
+                CYAN, NORMAL, BOLD_WHITE, cfg->test_title, NORMAL,
+                YELLOW, stats->mean_ns, NORMAL,
+                GRAY, stats->median_ns, stats->p99_ns, stats->stddev_ns,
+                stats->samples, stats->iterations, NORMAL);
+#ifdef ATTEST_PERF_COUNTERS
+            double ops = (double)stats->samples * (double)stats->iterations;
+            if (stats->perf.instructions >= 0 && stats->perf.cycles >= 0) {
+                attest_print("%s        %.1f instructions/op, %.1f cycles/op%s\n",
+                    GRAY, (double)stats->perf.instructions / ops, (double)stats->perf.cycles / ops, NORMAL);
+            }
+#endif
+        }
+        break;
+    case MISSING_EXPECTATION:
+        empty_count++;
+        attest_print(
+            "%s[MISSING ASSERTION]%s %s%s%s\n",
+            MAGENTA,
+            NORMAL,
+            BOLD_WHITE,
+            attest_internal_current_test->test_title,
+            NORMAL);
+        attest_print("%s Location:%s %s%s:%d%s\n\n",
+            CYAN, NORMAL, GRAY, cfg->filename,
+            cfg->line,
+            NORMAL);
+        break;
+    case FAILED:
+        fail_count++;
+        attest_print(
+            "%s[FAIL]%s %s%s%s\n",
+            RED, NORMAL, BOLD_WHITE,
+            cfg->test_title,
+            NORMAL);
+        bool more_than_one_attempt = test_attempt_count > 1;
+        for (int i = 0; i < test_attempt_count; i++) {
+            bool is_last_attempt = i == test_attempt_count - 1;
+
+            if (more_than_one_attempt) {
+                attest_print("%s%sTest attempt: %d%s\n",
+                    GRAY,
+                    is_last_attempt ? LEAF : BRANCH,
+                    i + 1,
+                    NORMAL);
+            }
+
+            if (more_than_one_attempt) {
+                display_failures(
+                    i,
+                    is_last_attempt
+                        ? "   "
+                        : TRUNK "  ");
+            } else {
+                display_failures(i, "");
+            }
+        }
+        break;
+    case TIMED_OUT:
+        timeout_count++;
+        attest_print(
+            "%s[TIMEOUT]%s %s%s%s\n",
+            RED, NORMAL, BOLD_WHITE,
+            cfg->test_title,
+            NORMAL);
+        attest_print("%s Limit:%s %d ms\n", CYAN, NORMAL, timeout_ms);
+        attest_print("%s Location:%s %s%s:%d%s\n\n",
+            CYAN, NORMAL, GRAY, cfg->filename,
+            cfg->line,
+            NORMAL);
+        break;
+    default:
+        fprintf(stderr, "%s[ATTEST ERROR] Reach unreachable state. Print debug logs and file issue%s\n", RED, NORMAL);
+    }
+}
+
+// Returns false when `--shard-cases` gave every case to other shards.
+bool run_parameterize_test(TestConfig* test_config)
+{
+    test_config->param_init();
+
+    if (case_count == 0 && !test_config->streams_cases) {
+        fprintf(stderr, "%s[ATTEST ERROR] Pass values enclosed within parenthesis when using `PARAM_TEST` or `PARAM_TEST_CTX`.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    attest_reserve_cases(case_count);
+
+    global_param_context.all = attest_context.global_shared_data;
+    attest_case_retries = attest_history_allows_retries(test_config->test_title);
+    attest_case_retried = false;
+
+    if (parameterize_before_all_cases != NULL) {
+        parameterize_before_all_cases(&global_param_context);
+    }
+
+    test_config->param_test_runner();
+
+    for (int i = 0; i < case_count; i++) {
+        InstanceResult* case_result = &parameterize_instance_results[i];
+        attest_record_timing((TimingRecord) {
+            .test_title = test_config->test_title,
+            .case_index = case_result->case_index,
+            .filename = test_config->filename,
+            .line = test_config->line,
+            .wall_ns = case_result->wall_ns,
+            .cpu_ns = case_result->cpu_ns },
+            case_result->case_name);
+    }
+
+    bool empty_tests_are_present = any_instance(MISSING_EXPECTATION);
+
+    bool every_instance_pass = every_instance(PASSED);
+
+    if (attest_stream_empty) {
+        // Like a test without expectations, so the run goes on.
+        test_config->status = MISSING_EXPECTATION;
+        empty_count++;
+        attest_print(
+            "%s[MISSING ASSERTION]%s %s%s%s\n",
+            MAGENTA,
+            NORMAL,
+            BOLD_WHITE, test_config->test_title, NORMAL);
+        attest_print(
+            "%s NOTE:%s The provider of `PARAM_TEST_STREAM` yielded no cases.\n",
+            CYAN, NORMAL);
+        attest_print("%s Location:%s %s%s:%d%s\n\n",
+            CYAN, NORMAL, GRAY, test_config->filename,
+            test_config->line, NORMAL);
+    } else if (attest_cases_run == 0) {
+        // No case of this test belongs to the shard, so there is nothing to report.
+    } else if (every_instance_pass) {
+        test_config->status = PASSED;
+        pass_count++;
+    } else if (empty_tests_are_present) {
+        test_config->status = MISSING_EXPECTATION;
+        empty_count++;
+        attest_print(
+            "%s[MISSING ASSERTION]%s %s%s%s\n",
+            MAGENTA,
+            NORMAL,
+            BOLD_WHITE, test_config->test_title, NORMAL);
+        attest_print(
+            "%s NOTE:%s Every case of a pareametize test must have atleast one expectation.\n",
+            CYAN, NORMAL);
+        attest_print("%s Location:%s %s%s:%d%s\n\n",
+            CYAN, NORMAL, GRAY, test_config->filename,
+            test_config->line, NORMAL);
+    } else {
+        test_config->status = FAILED;
+        fail_count++;
+
+        int amount_of_failed_cases = 0;
+
+        for (int i = 0; i < case_count; i++) {
+            switch (parameterize_instance_results[i].status) {
+            case PASSED:
+                break;
+            case FAILED:
+            case TIMED_OUT:
+                amount_of_failed_cases++;
                 break;
             case MISSING_EXPECTATION:
                 fprintf(
@@ -472,477 +4303,3142 @@ void run_parameterize_test(TestConfig* test_config)
                 exit(1); // NOLINT
                 break;
             default:
-                fprintf(
-                    stderr,
-                    "%s[ERROR] Reached unreachable state. File issue%s\n",
-                    RED,
-                    NORMAL);
-                exit(1); // NOLINT
+                fprintf(
+                    stderr,
+                    "%s[ERROR] Reached unreachable state. File issue%s\n",
+                    RED,
+                    NORMAL);
+                exit(1); // NOLINT
+            }
+        }
+
+        attest_print(
+            "%s[FAIL]%s %s%s%s (%s%d/%d failed%s)\n",
+            BOLD_RED, NORMAL, BOLD_WHITE,
+            test_config->test_title,
+            NORMAL,
+            RED, amount_of_failed_cases, attest_cases_run, NORMAL);
+
+        attest_print("%s%s%s\n", GRAY, TRUNK, NORMAL);
+
+        for (int i = 0, case_index = 0; i < amount_of_failed_cases; case_index++) {
+            InstanceResult* case_result = &parameterize_instance_results[case_index];
+
+            if (case_result->status == PASSED) {
+                continue;
+            }
+
+            bool is_last_failed_case = i == amount_of_failed_cases - 1;
+
+            attest_print(
+                "%s%s Case [%d]:%s %s%s%s\n",
+                GRAY,
+                is_last_failed_case ? LEAF : BRANCH,
+                i + 1,
+                NORMAL,
+                RED,
+                case_result->case_name[0] == '\0'
+                    ? "<unnamed>"
+                    : case_result->case_name,
+                NORMAL);
+
+            if (case_result->status == TIMED_OUT) {
+                attest_print("%s%s%s%s %sTimed out before the case finished%s\n",
+                    GRAY,
+                    is_last_failed_case ? "    " : TRUNK "   ",
+                    case_result->failure_count == 0 ? LEAF : BRANCH,
+                    NORMAL, RED, NORMAL);
+            }
+
+            for (int j = 0; j < case_result->failure_count; j++) {
+                bool is_last_failure = j == case_result->failure_count - 1;
+
+                if (is_last_failed_case) {
+                    attest_print("    ");
+                } else {
+                    attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                }
+
+                FailureInfo* case_failure_info = &case_result->failures[j];
+                FailureText case_failure_text;
+                attest_render_failure(case_failure_info, &case_failure_text);
+
+                attest_print(
+                    "%s%s%s %s@L%d: %s\n",
+                    GRAY,
+                    is_last_failure ? LEAF : BRANCH,
+                    NORMAL,
+                    case_failure_info->filename,
+                    case_failure_info->line,
+                    case_failure_text.verification_text);
+
+                bool expected_has_label = strcmp(case_failure_text.expected_label, case_failure_text.expected_value) != 0;
+                if (case_failure_info->has_expected_value && expected_has_label) {
+                    if (is_last_failed_case) {
+                        attest_print("    ");
+                    } else {
+                        attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                    }
+
+                    if (is_last_failure) {
+                        attest_print("    ");
+                    } else {
+                        attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                    }
+
+                    attest_print("%s = %s\n", case_failure_text.expected_label, case_failure_text.expected_value);
+                }
+
+                if (is_last_failed_case) {
+                    attest_print("    ");
+                } else {
+                    attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                }
+
+                if (is_last_failure) {
+                    attest_print("    ");
+                } else {
+                    attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                }
+
+                bool actual_has_label = strcmp(case_failure_text.actual_label, case_failure_text.actual_value) != 0;
+
+                if (actual_has_label) {
+                    attest_print("%s = %s\n", case_failure_text.actual_label, case_failure_text.actual_value);
+                }
+
+                if (case_failure_info->has_msg) {
+                    if (is_last_failed_case) {
+                        attest_print("    ");
+                    } else {
+                        attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                    }
+
+                    if (is_last_failure) {
+                        attest_print("    ");
+                    } else {
+                        attest_print("%s%s%s   ", GRAY, TRUNK, NORMAL);
+                    }
+
+                    attest_print("%sMessage: %s%s\n", CYAN, case_failure_info->msg, NORMAL);
+                }
+                if (!is_last_failed_case && !is_last_failure) {
+                    attest_print("%s%s   %s%s\n", GRAY, TRUNK, TRUNK, NORMAL);
+                }
+
+                if (!is_last_failed_case && is_last_failure) {
+                    attest_print("%s%s%s   \n", GRAY, TRUNK, NORMAL);
+                }
+
+                if (is_last_failed_case && !is_last_failure) {
+                    attest_print("%s    %s%s\n", GRAY, TRUNK, NORMAL);
+                }
+            }
+
+            i++;
+        }
+    }
+
+    if (attest_cases_run > 0) {
+        attest_print("\n");
+    }
+
+    if (parameterize_after_all_cases != NULL) {
+        parameterize_after_all_cases(&global_param_context);
+    }
+
+    global_param_context.all = NULL;
+    global_param_context.set = NULL;
+    global_param_context.self = NULL;
+
+    parameterize_before_all_cases = NULL;
+    parameterize_after_all_cases = NULL;
+
+    bool reported = attest_cases_run > 0 || attest_stream_empty;
+    attest_stream_empty = false;
+    return reported;
+}
+
+// True once `--fail-fast` or `--max-failures` has seen enough failed tests.
+bool attest_should_stop(void)
+{
+    int limit = attest_context.max_failures;
+    return limit > 0 && fail_count + empty_count + timeout_count + crash_count >= limit;
+}
+
+void attest_run_test(TestConfig* test_config)
+{
+    // A suite is the run of consecutive tests from one file.
+    if (attest_fixture_suite != NULL && strcmp(attest_fixture_suite, test_config->filename) != 0) {
+        attest_teardown_fixtures(ATTEST_SCOPE_SUITE);
+    }
+    attest_fixture_suite = test_config->filename;
+    attest_begin_impact();
+
+    if (test_config->param_test_runner) {
+        AttestClock test_start = attest_clock_now();
+        if (!run_parameterize_test(test_config)) {
+            attest_teardown_fixtures(ATTEST_SCOPE_TEST);
+            attest_end_impact(NULL);
+            return;
+        }
+        AttestClock test_duration = attest_clock_since(test_start);
+        test_config->wall_ns = test_duration.wall_ns;
+        test_config->cpu_ns = test_duration.cpu_ns;
+    } else {
+        attest_internal_current_test = test_config;
+        attester();
+        attest_internal_current_test = NULL;
+    }
+
+    attest_teardown_case_fixtures();
+    attest_teardown_fixtures(ATTEST_SCOPE_TEST);
+    attest_end_impact(test_config);
+
+    attest_report_record(test_config, NULL);
+    attest_record_history(test_config, attest_history_outcome(test_config),
+        test_config->param_test_runner == NULL ? test_attempt_count : 1);
+
+    attest_reset_attempts();
+
+    if (test_config->param_test_runner) {
+        attest_reset_cases(case_count);
+        case_count = 0;
+        attest_cases_run = 0;
+    }
+
+    // Benchmarks run as long as they need, so they'd crowd `--slowest`.
+    if (!test_config->skip && !test_config->benchmark) {
+        attest_record_timing((TimingRecord) {
+            .test_title = test_config->test_title,
+            .case_index = -1,
+            .filename = test_config->filename,
+            .line = test_config->line,
+            .wall_ns = test_config->wall_ns,
+            .cpu_ns = test_config->cpu_ns },
+            NULL);
+    }
+
+    total_tests++;
+
+    attest_flush_output();
+}
+
+#ifdef ATTEST_POSIX
+bool attest_read_all(int fd, void* buffer, size_t size)
+{
+    char* cursor = buffer;
+
+    while (size > 0) {
+        ssize_t received = read(fd, cursor, size);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        cursor += received;
+        size -= (size_t)received;
+    }
+
+    return true;
+}
+
+bool attest_write_all(int fd, const void* buffer, size_t size)
+{
+    const char* cursor = buffer;
+
+    while (size > 0) {
+        ssize_t sent = write(fd, cursor, size);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        cursor += sent;
+        size -= (size_t)sent;
+    }
+
+    return true;
+}
+
+// Runs tests handed out by the parent until it sends a negative index.
+// Reports are written to a scratch file so each test's report can be
+// sent back to the parent in one piece. The test's own stdout is
+// captured with it unless reports go to a separate descriptor.
+void attest_worker_loop(TestConfig** selected_tests, int command_fd, int result_fd)
+{
+    FILE* capture = tmpfile();
+    int capture_fd = capture != NULL ? fileno(capture) : -1;
+
+    if (capture == NULL
+        || (attest_output_fd == STDOUT_FILENO && dup2(capture_fd, STDOUT_FILENO) < 0)) {
+        fprintf(stderr, "%s[ATTEST ERROR] Unable to capture output of test worker.%s\n", RED, NORMAL);
+        _exit(1);
+    }
+
+    attest_output_fd = capture_fd;
+    attest_worker_result_fd = result_fd;
+    // The other workers already keep the cores busy, so properties search
+    // on this thread alone.
+    attest_context.job_count = 1;
+
+    int test_index = -1;
+
+    while (attest_read_all(command_fd, &test_index, sizeof test_index) && test_index >= 0) {
+        total_tests = 0;
+        pass_count = 0;
+        fail_count = 0;
+        skip_count = 0;
+        empty_count = 0;
+        timeout_count = 0;
+        attest_slowest_count = 0;
+
+        attest_run_test(selected_tests[test_index]);
+
+        off_t output_size = lseek(capture_fd, 0, SEEK_CUR);
+
+        WorkerReport report = {
+            .test_index = test_index,
+            .total_tests = total_tests,
+            .pass_count = pass_count,
+            .fail_count = fail_count,
+            .skip_count = skip_count,
+            .empty_count = empty_count,
+            .timeout_count = timeout_count,
+            .output_size = output_size > 0 ? (size_t)output_size : 0,
+            .timing_count = attest_slowest_count,
+            .fixture_index = -1
+        };
+
+        if (!attest_write_all(result_fd, &report, sizeof report)) {
+            _exit(1);
+        }
+
+        (void)lseek(capture_fd, 0, SEEK_SET);
+        char chunk[4096];
+        size_t remaining = report.output_size;
+        while (remaining > 0) {
+            size_t chunk_size = remaining < sizeof chunk ? remaining : sizeof chunk;
+            if (!attest_read_all(capture_fd, chunk, chunk_size)
+                || !attest_write_all(result_fd, chunk, chunk_size)) {
+                _exit(1);
+            }
+            remaining -= chunk_size;
+        }
+
+        (void)lseek(capture_fd, 0, SEEK_SET);
+        (void)ftruncate(capture_fd, 0);
+
+        size_t timings_size = sizeof(TimingRecord) * (size_t)attest_slowest_count;
+        if (!attest_write_all(result_fd, attest_slowest, timings_size)) {
+            _exit(1);
+        }
+    }
+
+    attest_teardown_fixtures(ATTEST_SCOPE_SUITE);
+
+    _exit(0);
+}
+
+// Ends the worker in the middle of its test, so the parent builds the
+// process scoped fixture and reruns the test in a worker that has it.
+// The captured output, counts and timings of the attempt only reach the
+// parent with a finished report, so `_exit` drops them, along with
+// stdout that wasn't flushed yet.
+void attest_request_fixture(AttestFixture* fixture)
+{
+    int fixture_index = 0;
+    for (AttestFixture* other = attest_fixture_head; other != fixture; other = other->next) {
+        fixture_index++;
+    }
+
+    WorkerReport report = {
+        .test_index = -1,
+        .fixture_index = fixture_index
+    };
+
+    (void)attest_write_all(attest_worker_result_fd, &report, sizeof report);
+    _exit(0);
+}
+
+bool attest_spawn_worker(AttestWorker* workers, int worker_index, TestConfig** selected_tests)
+{
+    int command_pipe[2];
+    int result_pipe[2];
+
+    if (pipe(command_pipe) != 0) {
+        return false;
+    }
+
+    if (pipe(result_pipe) != 0) {
+        close(command_pipe[0]);
+        close(command_pipe[1]);
+        return false;
+    }
+
+    attest_flush_output();
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        close(command_pipe[0]);
+        close(command_pipe[1]);
+        close(result_pipe[0]);
+        close(result_pipe[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // Drop the pipes of sibling workers so the parent sees EOF
+        // as soon as any of them exits.
+        for (int i = 0; i < worker_index; i++) {
+            if (workers[i].pid > 0) {
+                close(workers[i].command_fd);
+                close(workers[i].result_fd);
+            }
+        }
+        close(command_pipe[1]);
+        close(result_pipe[0]);
+        attest_worker_loop(selected_tests, command_pipe[0], result_pipe[1]);
+    }
+
+    close(command_pipe[0]);
+    close(result_pipe[1]);
+
+    workers[worker_index] = (AttestWorker) {
+        .pid = pid,
+        .command_fd = command_pipe[1],
+        .result_fd = result_pipe[0],
+        .test_index = -1
+    };
+
+    return true;
+}
+
+void attest_stop_worker(AttestWorker* worker)
+{
+    int stop = -1;
+    (void)attest_write_all(worker->command_fd, &stop, sizeof stop);
+    close(worker->command_fd);
+    close(worker->result_fd);
+    (void)waitpid(worker->pid, NULL, 0);
+    worker->pid = -1;
+}
+
+// Hands the next pending test to an idle worker or stops the worker
+// when none are left.
+void attest_dispatch(AttestWorker* worker, int* next_test, int selected_count)
+{
+    if (*next_test >= selected_count || attest_should_stop()) {
+        attest_stop_worker(worker);
+        return;
+    }
+
+    worker->test_index = *next_test;
+    (*next_test)++;
+
+    // A failed write means the worker is gone. Its result pipe reports
+    // EOF on the next poll and the test is reported as lost.
+    (void)attest_write_all(worker->command_fd, &worker->test_index, sizeof worker->test_index);
+}
+
+// Reads one report from a worker and merges it into the parent. Returns
+// false when the worker exited before finishing its test. A worker that
+// needs a process scoped fixture is reaped once the fixture is built,
+// and keeps its test so the caller can start it over.
+bool attest_collect_report(AttestWorker* worker)
+{
+    WorkerReport report;
+
+    if (!attest_read_all(worker->result_fd, &report, sizeof report)) {
+        return false;
+    }
+
+    if (report.fixture_index >= 0) {
+        close(worker->command_fd);
+        close(worker->result_fd);
+        (void)waitpid(worker->pid, NULL, 0);
+        worker->pid = -1;
+
+        AttestFixture* fixture = attest_fixture_head;
+        for (int i = 0; i < report.fixture_index && fixture != NULL; i++) {
+            fixture = fixture->next;
+        }
+        if (fixture != NULL) {
+            (void)attest_use_fixture(fixture);
+        }
+
+        return true;
+    }
+
+    char chunk[4096];
+    size_t remaining = report.output_size;
+    while (remaining > 0) {
+        size_t chunk_size = remaining < sizeof chunk ? remaining : sizeof chunk;
+        if (!attest_read_all(worker->result_fd, chunk, chunk_size)) {
+            return false;
+        }
+        attest_write_output(chunk, chunk_size);
+        remaining -= chunk_size;
+    }
+    attest_flush_output();
+
+    for (int i = 0; i < report.timing_count; i++) {
+        TimingRecord record;
+        if (!attest_read_all(worker->result_fd, &record, sizeof record)) {
+            return false;
+        }
+        attest_record_timing(record, NULL);
+    }
+
+    total_tests += report.total_tests;
+    pass_count += report.pass_count;
+    fail_count += report.fail_count;
+    skip_count += report.skip_count;
+    empty_count += report.empty_count;
+    timeout_count += report.timeout_count;
+
+    worker->test_index = -1;
+
+    return true;
+}
+
+const char* attest_signal_name(int signal_number)
+{
+    switch (signal_number) {
+    case SIGSEGV:
+        return "SIGSEGV";
+    case SIGABRT:
+        return "SIGABRT";
+    case SIGBUS:
+        return "SIGBUS";
+    case SIGFPE:
+        return "SIGFPE";
+    case SIGILL:
+        return "SIGILL";
+    case SIGTRAP:
+        return "SIGTRAP";
+    case SIGSYS:
+        return "SIGSYS";
+    case SIGKILL:
+        return "SIGKILL";
+    case SIGTERM:
+        return "SIGTERM";
+    case SIGPIPE:
+        return "SIGPIPE";
+    case SIGALRM:
+        return "SIGALRM";
+    default:
+        return NULL;
+    }
+}
+
+// Reports the test a worker was running when it died and reaps the
+// worker. A signal marks the test as crashed, an early exit as failed.
+void attest_report_lost_test(AttestWorker* worker, TestConfig* lost_test)
+{
+    close(worker->command_fd);
+    close(worker->result_fd);
+
+    int wait_status = 0;
+    pid_t reaped = waitpid(worker->pid, &wait_status, 0);
+    worker->pid = -1;
+
+    char reason[ATTEST_VALUE_BUF];
+    bool crashed = reaped > 0 && WIFSIGNALED(wait_status);
+
+    if (crashed) {
+        int signal_number = WTERMSIG(wait_status);
+        const char* signal_name = attest_signal_name(signal_number);
+        if (signal_name != NULL) {
+            (void)snprintf(reason, sizeof reason, "Crashed with %s (%s).", signal_name, strsignal(signal_number));
+        } else {
+            (void)snprintf(reason, sizeof reason, "Crashed with signal %d (%s).", signal_number, strsignal(signal_number));
+        }
+    } else if (reaped > 0 && WIFEXITED(wait_status)) {
+        (void)snprintf(reason, sizeof reason, "Test worker exited with status %d before the test finished.", WEXITSTATUS(wait_status));
+    } else {
+        (void)snprintf(reason, sizeof reason, "Test worker exited before the test finished.");
+    }
+
+    attest_print(
+        "%s[%s]%s %s%s%s\n",
+        RED, crashed ? "CRASH" : "FAIL", NORMAL, BOLD_WHITE,
+        lost_test->test_title,
+        NORMAL);
+    attest_print("%s Reason:%s %s\n", CYAN, NORMAL, reason);
+    attest_print("%s Location:%s %s%s:%d%s\n\n",
+        CYAN, NORMAL, GRAY, lost_test->filename,
+        lost_test->line,
+        NORMAL);
+    lost_test->status = crashed ? CRASHED : FAILED;
+    attest_report_record(lost_test, reason);
+    attest_record_history(lost_test, crashed ? 'c' : 'f', 1);
+    attest_flush_output();
+    total_tests++;
+    if (crashed) {
+        crash_count++;
+    } else {
+        fail_count++;
+    }
+}
+
+// Runs a test with `.isolated` in a worker process while the others run
+// in this one. The worker is kept for the next isolated test until a
+// test takes it down.
+void attest_run_isolated(AttestWorker* worker, TestConfig** selected_tests, int test_index)
+{
+    if (worker->pid <= 0 && !attest_spawn_worker(worker, 0, selected_tests)) {
+        fprintf(stderr, "%s[ATTEST ERROR] Unable to start test worker.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    worker->test_index = test_index;
+    (void)attest_write_all(worker->command_fd, &test_index, sizeof test_index);
+
+    if (!attest_collect_report(worker)) {
+        attest_report_lost_test(worker, selected_tests[test_index]);
+    } else if (worker->pid < 0) {
+        attest_run_isolated(worker, selected_tests, test_index);
+    }
+}
+
+void attest_run_parallel(TestConfig** selected_tests, int selected_count, int job_count)
+{
+    AttestWorker workers[ATTEST_MAX_JOBS];
+    int worker_count = job_count < selected_count ? job_count : selected_count;
+    int next_test = 0;
+
+    for (int i = 0; i < worker_count; i++) {
+        if (!attest_spawn_worker(workers, i, selected_tests)) {
+            fprintf(stderr, "%s[ATTEST ERROR] Unable to start test worker.%s\n", RED, NORMAL);
+            exit(1); // NOLINT
+        }
+        attest_dispatch(&workers[i], &next_test, selected_count);
+    }
+
+    for (;;) {
+        struct pollfd poll_fds[ATTEST_MAX_JOBS];
+        int poll_owners[ATTEST_MAX_JOBS];
+        int poll_count = 0;
+
+        for (int i = 0; i < worker_count; i++) {
+            if (workers[i].pid > 0) {
+                poll_fds[poll_count] = (struct pollfd) { .fd = workers[i].result_fd, .events = POLLIN };
+                poll_owners[poll_count] = i;
+                poll_count++;
+            }
+        }
+
+        if (poll_count == 0) {
+            not_run_count = selected_count - next_test;
+            break;
+        }
+
+        if (poll(poll_fds, (nfds_t)poll_count, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "%s[ATTEST ERROR] Lost contact with test workers.%s\n", RED, NORMAL);
+            exit(1); // NOLINT
+        }
+
+        for (int i = 0; i < poll_count; i++) {
+            if (poll_fds[i].revents == 0) {
+                continue;
+            }
+
+            int worker_index = poll_owners[i];
+            AttestWorker* worker = &workers[worker_index];
+
+            if (attest_collect_report(worker)) {
+                if (worker->pid > 0) {
+                    attest_dispatch(worker, &next_test, selected_count);
+                    continue;
+                }
+
+                // Start the test over in a worker that inherits the fixture.
+                int test_index = worker->test_index;
+                if (!attest_spawn_worker(workers, worker_index, selected_tests)) {
+                    fprintf(stderr, "%s[ATTEST ERROR] Unable to restart test worker.%s\n", RED, NORMAL);
+                    exit(1); // NOLINT
+                }
+                worker->test_index = test_index;
+                (void)attest_write_all(worker->command_fd, &worker->test_index, sizeof worker->test_index);
+                continue;
+            }
+
+            attest_report_lost_test(worker, selected_tests[worker->test_index]);
+
+            if (next_test < selected_count && !attest_should_stop()) {
+                if (!attest_spawn_worker(workers, worker_index, selected_tests)) {
+                    fprintf(stderr, "%s[ATTEST ERROR] Unable to restart test worker.%s\n", RED, NORMAL);
+                    exit(1); // NOLINT
+                }
+                attest_dispatch(worker, &next_test, selected_count);
+            }
+        }
+    }
+}
+#endif
+
+#ifdef ATTEST_WATCH
+static volatile sig_atomic_t attest_watch_stopped = 0;
+
+void attest_stop_watch(int signal_number)
+{
+    (void)signal_number;
+    attest_watch_stopped = 1;
+}
+
+bool attest_watch_stamp(const char* path, WatchStamp* stamp)
+{
+    struct stat info;
+
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+
+    stamp->modified = info.st_mtime;
+    stamp->size = info.st_size;
+    stamp->inode = info.st_ino;
+
+    return true;
+}
+
+bool attest_same_stamp(const WatchStamp* left, const WatchStamp* right)
+{
+    return left->modified == right->modified && left->size == right->size && left->inode == right->inode;
+}
+
+// Runs the tests of the library in a child. Each run loads the library
+// afresh, so it starts from clean state, and a crash or an exit() only
+// ends that run.
+int attest_run_watched(const char* path, int argc, char* argv[])
+{
+    (void)fflush(stdout);
+    (void)fflush(stderr);
+
+    pid_t child = fork();
+
+    if (child < 0) {
+        fprintf(stderr, "%s[ATTEST ERROR] Unable to fork the watched run.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    if (child == 0) {
+        // dlopen only looks in the library paths for names without a slash.
+        char local_path[PATH_MAX];
+        (void)snprintf(local_path, sizeof local_path, "%s%s", strchr(path, '/') == NULL ? "./" : "", path);
+        void* library = dlopen(local_path, RTLD_NOW | RTLD_LOCAL);
+
+        if (library == NULL) {
+            fprintf(stderr, "%s[ERROR] Unable to load %s: %s%s\n", RED, path, dlerror(), NORMAL);
+            exit(1); // NOLINT
+        }
+
+        int (*run)(int, char**) = NULL;
+        *(void**)(&run) = dlsym(library, "attest_main");
+
+        if (run == NULL) {
+            fprintf(stderr, "%s[ERROR] %s has no tests. Build it from a file that includes attest.h.%s\n",
+                RED, path, NORMAL);
+            exit(1); // NOLINT
+        }
+
+        exit(run(argc, argv)); // NOLINT
+    }
+
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 1;
+        }
+    }
+
+    if (WIFSIGNALED(status) && !attest_watch_stopped) {
+        fprintf(stderr, "%s[ERROR] The run crashed with signal %d.%s\n", RED, WTERMSIG(status), NORMAL);
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+// Reruns the tests of a shared library each time it is rebuilt, until
+// interrupted. The runs share a history, so the tests that failed last
+// time and the tests that are new report first.
+int attest_watch(int argc, char* argv[])
+{
+    const char* path = attest_context.watch_path;
+    char history_path[] = "/tmp/attest-watch-XXXXXX";
+    char history_arg[sizeof history_path + 16];
+    char order_arg[] = "--order=failed-first";
+    char** child_argv = malloc(sizeof(char*) * (size_t)(argc + 3));
+    int child_argc = 0;
+    bool has_order = false;
+
+    if (child_argv == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while starting to watch.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "--watch=", 8) != 0) {
+            child_argv[child_argc++] = argv[i];
+        }
+        has_order = has_order || strncmp(argv[i], "--order=", 8) == 0;
+    }
+
+    if (attest_context.history_path == NULL) {
+        int history_fd = mkstemp(history_path);
+
+        if (history_fd < 0) {
+            fprintf(stderr, "%s[ATTEST ERROR] Unable to create the history of the watched runs.%s\n", RED, NORMAL);
+            exit(1); // NOLINT
+        }
+
+        (void)close(history_fd);
+        (void)snprintf(history_arg, sizeof history_arg, "--history=%s", history_path);
+        child_argv[child_argc++] = history_arg;
+    }
+
+    if (!has_order) {
+        child_argv[child_argc++] = order_arg;
+    }
+    child_argv[child_argc] = NULL;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof action);
+    action.sa_handler = attest_stop_watch;
+    sigemptyset(&action.sa_mask);
+    (void)sigaction(SIGINT, &action, NULL);
+    (void)sigaction(SIGTERM, &action, NULL);
+
+    printf("%s[WATCH] Watching %s. Press Ctrl-C to stop.%s\n", CYAN, path, NORMAL);
+
+    WatchStamp last_run = { 0 };
+    bool has_run = false;
+
+    while (!attest_watch_stopped) {
+        WatchStamp stamp;
+        WatchStamp settled;
+
+        // Waits a poll for the build to finish writing the library.
+        if (attest_watch_stamp(path, &stamp) && (!has_run || !attest_same_stamp(&stamp, &last_run))
+            && poll(NULL, 0, ATTEST_WATCH_POLL_MS) == 0 && attest_watch_stamp(path, &settled)
+            && attest_same_stamp(&stamp, &settled)) {
+            long long start = attest_wall_now();
+            int status = attest_run_watched(path, child_argc, child_argv);
+            double elapsed_ms = (double)(attest_wall_now() - start) / 1000000.0;
+
+            last_run = stamp;
+            has_run = true;
+
+            if (!attest_watch_stopped) {
+                printf("%s[WATCH] %s in %.1f ms. Waiting for changes to %s.%s\n",
+                    status == 0 ? GREEN : RED, status == 0 ? "Passed" : "Failed", elapsed_ms, path, NORMAL);
+                (void)fflush(stdout);
+            }
+            continue;
+        }
+
+        (void)poll(NULL, 0, ATTEST_WATCH_POLL_MS);
+    }
+
+    if (attest_context.history_path == NULL) {
+        (void)unlink(history_path);
+    }
+    free(child_argv);
+
+    return 0;
+}
+#endif
+
+int attest_main(int argc, char* argv[])
+{
+    int test_count = 0;
+    TestConfig* test_config = attest_registry_head;
+
+    bool has_tags = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tag") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr,
+                    "[ERROR] Please pass a tag argument to `--tag`\n");
+                exit(1);
+            }
+
+            if (attest_context.requested_tag_count == ATTEST_MAX_TAGS) {
+                fprintf(stderr,
+                    "[ERROR] Reached max amount of tags. Please define `ATTEST_MAX_TAGS` to higher limit\n");
+                exit(1);
+            }
+
+            strncpy(
+                attest_context.requested_tags[attest_context.requested_tag_count],
+                argv[i + 1],
+                20);
+
+            attest_context.requested_tags[attest_context.requested_tag_count][20] = '\0';
+            attest_context.requested_tag_count++;
+            has_tags = true;
+        } else if (strncmp(argv[i], "--jobs", 6) == 0) {
+            char* value = argv[i] + 6;
+            long job_count = 0;
+
+            if (*value == '\0') {
+#ifdef ATTEST_POSIX
+                job_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+            } else if (*value == '=') {
+                char* end = NULL;
+                job_count = strtol(value + 1, &end, 10);
+                if (end == value + 1 || *end != '\0' || job_count < 1) {
+                    fprintf(stderr,
+                        "[ERROR] `--jobs` expects a positive number of workers, e.g. `--jobs=4`\n");
+                    exit(1);
+                }
+            } else {
+                continue;
+            }
+
+            if (job_count > ATTEST_MAX_JOBS) {
+                job_count = ATTEST_MAX_JOBS;
+            }
+
+            attest_context.job_count = job_count > 0 ? (int)job_count : 1;
+        } else if (strncmp(argv[i], "--slowest=", 10) == 0) {
+            char* end = NULL;
+            long slowest_limit = strtol(argv[i] + 10, &end, 10);
+
+            if (end == argv[i] + 10 || *end != '\0' || slowest_limit < 1) {
+                fprintf(stderr,
+                    "[ERROR] `--slowest` expects a positive number of tests, e.g. `--slowest=10`\n");
+                exit(1);
+            }
+
+            attest_context.slowest_limit = slowest_limit > ATTEST_MAX_SLOWEST
+                ? ATTEST_MAX_SLOWEST
+                : (int)slowest_limit;
+        } else if (strncmp(argv[i], "--timeout=", 10) == 0) {
+            char* end = NULL;
+            long timeout_ms = strtol(argv[i] + 10, &end, 10);
+
+            if (end == argv[i] + 10 || *end != '\0' || timeout_ms < 1 || timeout_ms > 86400000) {
+                fprintf(stderr,
+                    "[ERROR] `--timeout` expects a limit in milliseconds, e.g. `--timeout=500`\n");
+                exit(1);
+            }
+
+            attest_context.timeout_ms = (int)timeout_ms;
+        } else if (strncmp(argv[i], "--output-fd=", 12) == 0) {
+            char* end = NULL;
+            long output_fd = strtol(argv[i] + 12, &end, 10);
+
+            if (end == argv[i] + 12 || *end != '\0' || output_fd < 0 || output_fd > 65535) {
+                fprintf(stderr,
+                    "[ERROR] `--output-fd` expects a file descriptor, e.g. `--output-fd=3`\n");
+                exit(1);
+            }
+
+#ifdef ATTEST_POSIX
+            if (fcntl((int)output_fd, F_GETFL) < 0) {
+                fprintf(stderr,
+                    "[ERROR] `--output-fd=%ld` is not an open file descriptor\n", output_fd);
+                exit(1);
+            }
+#endif
+
+            attest_output_fd = (int)output_fd;
+        } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+            attest_context.filter = argv[i] + 9;
+        } else if (strncmp(argv[i], "--shard=", 8) == 0) {
+            char* end = NULL;
+            long shard_index = strtol(argv[i] + 8, &end, 10);
+            long shard_count = 0;
+
+            if (end != argv[i] + 8 && *end == '/') {
+                char* count_start = end + 1;
+                shard_count = strtol(count_start, &end, 10);
+                if (end == count_start) {
+                    shard_count = 0;
+                }
+            }
+
+            if (*end != '\0' || shard_count < 1 || shard_count > 100000 || shard_index < 1 || shard_index > shard_count) {
+                fprintf(stderr,
+                    "[ERROR] `--shard` expects INDEX/TOTAL with 1 <= INDEX <= TOTAL, e.g. `--shard=2/8`\n");
+                exit(1);
+            }
+
+            attest_context.shard_index = (int)shard_index - 1;
+            attest_context.shard_count = (int)shard_count;
+        } else if (strcmp(argv[i], "--shard-cases") == 0) {
+            attest_context.shard_cases = true;
+        } else if (strncmp(argv[i], "--baseline=", 11) == 0) {
+            attest_context.baseline_path = argv[i] + 11;
+
+            if (*attest_context.baseline_path == '\0') {
+                fprintf(stderr,
+                    "[ERROR] `--baseline` expects a file, e.g. `--baseline=timings.txt`\n");
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--update-baseline") == 0) {
+            attest_context.update_baseline = true;
+        } else if (strncmp(argv[i], "--baseline-tolerance=", 21) == 0) {
+            char* end = NULL;
+            long tolerance = strtol(argv[i] + 21, &end, 10);
+
+            if (end == argv[i] + 21 || *end != '\0' || tolerance < 0 || tolerance > 100000) {
+                fprintf(stderr,
+                    "[ERROR] `--baseline-tolerance` expects a percentage, e.g. `--baseline-tolerance=10`\n");
+                exit(1);
+            }
+
+            attest_context.baseline_tolerance = (int)tolerance;
+        } else if (strncmp(argv[i], "--impact-map=", 13) == 0) {
+            attest_context.impact_map_path = argv[i] + 13;
+
+            if (*attest_context.impact_map_path == '\0') {
+                fprintf(stderr,
+                    "[ERROR] `--impact-map` expects a file, e.g. `--impact-map=impact.txt`\n");
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--affected=", 11) == 0) {
+            attest_context.affected_path = argv[i] + 11;
+
+            if (*attest_context.affected_path == '\0') {
+                fprintf(stderr,
+                    "[ERROR] `--affected` expects a file listing changed sources, or `-` for stdin\n");
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--history=", 10) == 0) {
+            attest_context.history_path = argv[i] + 10;
+
+            if (*attest_context.history_path == '\0') {
+                fprintf(stderr,
+                    "[ERROR] `--history` expects a file, e.g. `--history=history.txt`\n");
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--order=", 8) == 0) {
+            const char* order = argv[i] + 8;
+
+            if (strcmp(order, "declared") == 0) {
+                attest_context.order = ATTEST_ORDER_DECLARED;
+            } else if (strcmp(order, "failed-first") == 0) {
+                attest_context.order = ATTEST_ORDER_FAILED_FIRST;
+            } else {
+                fprintf(stderr,
+                    "[ERROR] `--order` expects one of `declared` or `failed-first`\n");
+                exit(1);
+            }
+        } else if (strncmp(argv[i], "--watch=", 8) == 0) {
+            attest_context.watch_path = argv[i] + 8;
+
+            if (*attest_context.watch_path == '\0') {
+                fprintf(stderr,
+                    "[ERROR] `--watch` expects a shared library of tests, e.g. `--watch=./libtests.so`\n");
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--shuffle") == 0) {
+            attest_context.shuffle = true;
+        } else if (strncmp(argv[i], "--shuffle=", 10) == 0) {
+            char* end = NULL;
+            errno = 0;
+            unsigned long long seed = strtoull(argv[i] + 10, &end, 10);
+
+            if (end == argv[i] + 10 || *end != '\0' || errno == ERANGE || seed == 0 || argv[i][10] == '-') {
+                fprintf(stderr,
+                    "[ERROR] `--shuffle` expects a positive seed, e.g. `--shuffle=42`\n");
+                exit(1);
+            }
+
+            attest_context.shuffle = true;
+            attest_context.shuffle_seed = seed;
+        } else if (strcmp(argv[i], "--shuffle-cases") == 0) {
+            attest_context.shuffle_cases = true;
+        } else if (strcmp(argv[i], "--isolate") == 0) {
+            attest_context.isolate = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            attest_context.run_benches = true;
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            char* end = NULL;
+            errno = 0;
+            unsigned long long seed = strtoull(argv[i] + 7, &end, 10);
+
+            if (end == argv[i] + 7 || *end != '\0' || errno == ERANGE || seed == 0 || argv[i][7] == '-') {
+                fprintf(stderr,
+                    "[ERROR] `--seed` expects a positive number, e.g. `--seed=42`\n");
+                exit(1);
+            }
+
+            attest_context.seed = seed;
+        } else if (strcmp(argv[i], "--list") == 0) {
+            attest_context.list_only = true;
+        } else if (strcmp(argv[i], "--fail-fast") == 0) {
+            attest_context.max_failures = 1;
+        } else if (strncmp(argv[i], "--max-failures=", 15) == 0) {
+            char* end = NULL;
+            long max_failures = strtol(argv[i] + 15, &end, 10);
+
+            if (end == argv[i] + 15 || *end != '\0' || max_failures < 1 || max_failures > 1000000000) {
+                fprintf(stderr,
+                    "[ERROR] `--max-failures` expects a positive number of tests, e.g. `--max-failures=5`\n");
+                exit(1);
+            }
+
+            attest_context.max_failures = (int)max_failures;
+        } else if (strncmp(argv[i], "--format=", 9) == 0) {
+            char* format = argv[i] + 9;
+
+            if (strcmp(format, "text") == 0) {
+                attest_context.format = ATTEST_FORMAT_TEXT;
+            } else if (strcmp(format, "junit") == 0) {
+                attest_context.format = ATTEST_FORMAT_JUNIT;
+            } else if (strcmp(format, "jsonl") == 0) {
+                attest_context.format = ATTEST_FORMAT_JSONL;
+            } else if (strcmp(format, "tap") == 0) {
+                attest_context.format = ATTEST_FORMAT_TAP;
+            } else {
+                fprintf(stderr,
+                    "[ERROR] `--format` expects one of `text`, `junit`, `jsonl` or `tap`\n");
+                exit(1);
+            }
+        }
+    }
+
+    if (attest_context.watch_path != NULL) {
+#ifdef ATTEST_WATCH
+        return attest_watch(argc, argv);
+#else
+        fprintf(stderr, "[ERROR] `--watch` needs a runner built with `ATTEST_WATCH`\n");
+        exit(1);
+#endif
+    }
+
+    // Properties draw from a new seed each run unless `--seed` repeats
+    // one. Workers inherit it, so a test gets the same inputs wherever
+    // it runs.
+    if (attest_context.seed == 0) {
+        attest_context.seed = attest_mix((unsigned long long)attest_wall_now() ^ (unsigned long long)(size_t)&argc);
+    }
+
+    if (attest_context.shuffle && attest_context.shuffle_seed == 0) {
+        attest_context.shuffle_seed = attest_mix(attest_context.seed);
+    }
+
+    // Reports still buffered when a test or the runner calls exit() are
+    // written out on the way down.
+    (void)atexit(attest_flush_output);
+
+#ifndef ATTEST_POSIX
+    if (attest_context.timeout_ms > 0) {
+        fprintf(stderr,
+            "%s[WARNING] `--timeout` is not supported on this platform. Tests run without a limit.%s\n",
+            YELLOW, NORMAL);
+    }
+
+    if (attest_output_fd != ATTEST_OUTPUT_FD) {
+        fprintf(stderr,
+            "%s[WARNING] `--output-fd` is not supported on this platform. Reports go to stdout.%s\n",
+            YELLOW, NORMAL);
+    }
+
+    if (attest_context.job_count > 1) {
+        fprintf(stderr,
+            "%s[WARNING] `--jobs` is not supported on this platform. Running tests serially.%s\n",
+            YELLOW, NORMAL);
+        attest_context.job_count = 1;
+    }
+
+    if (attest_context.isolate) {
+        fprintf(stderr,
+            "%s[WARNING] `--isolate` is not supported on this platform. Running tests in this process.%s\n",
+            YELLOW, NORMAL);
+        attest_context.isolate = false;
+    }
+#endif
+
+#ifdef ATTEST_GROWABLE_STORAGE
+    size_t registered_count = 0;
+    for (TestConfig* entry = attest_registry_head; entry != NULL; entry = entry->next) {
+        registered_count++;
+    }
+
+    size_t title_slot_count = registered_count * 2 + 1;
+    attest_seen_titles = calloc(title_slot_count, sizeof(char*));
+    attest_selected_tests = calloc(registered_count + 1, sizeof(TestConfig*));
+
+    if (attest_seen_titles == NULL || attest_selected_tests == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while sizing the test registry.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+    size_t selected_capacity = registered_count + 1;
+#else
+    size_t title_slot_count = ATTEST_MAX_TESTS * 2;
+    size_t selected_capacity = ATTEST_MAX_TESTS;
+#endif
+
+    // Without a map from an earlier run, `--affected` runs every test.
+    if (attest_context.affected_path != NULL) {
+        if (attest_context.impact_map_path == NULL) {
+            fprintf(stderr, "[ERROR] `--affected` needs the `--impact-map=<file>` of an earlier run\n");
+            exit(1);
+        }
+
+        attest_load_affected(attest_context.affected_path);
+
+        if (!attest_load_impact_map(attest_context.impact_map_path)) {
+            fprintf(stderr, "%s[WARNING] No impact map at %s yet. Running every test.%s\n",
+                YELLOW, attest_context.impact_map_path, NORMAL);
+        }
+    }
+
+#ifndef ATTEST_IMPACT
+    if (attest_context.impact_map_path != NULL && attest_context.affected_path == NULL) {
+        fprintf(stderr,
+            "[ERROR] Recording `--impact-map` needs `ATTEST_IMPACT` and code built with `-finstrument-functions`\n");
+        exit(1);
+    }
+#endif
+
+    if (attest_context.history_path != NULL) {
+        attest_load_history(attest_context.history_path);
+    } else if (attest_context.order == ATTEST_ORDER_FAILED_FIRST) {
+        fprintf(stderr, "[ERROR] `--order=failed-first` needs the `--history=<file>` of earlier runs\n");
+        exit(1);
+    }
+
+    attest_index_requested_tags();
+
+    // Tests fill the selection from the front, benchmarks from the back.
+    TestConfig** selected_tests = attest_selected_tests;
+    int selected_count = 0;
+    int selected_bench_count = 0;
+    bool a_single_test_matched_the_tags = false;
+
+    while (test_config) {
+#ifndef ATTEST_GROWABLE_STORAGE
+        if (test_count == ATTEST_MAX_TESTS) {
+            fprintf(stderr,
+                "[ERROR] Reached max allowed tests. Define MACRO "
+                "ATTEST_MAX_TESTS to higher limit or define ATTEST_GROWABLE_STORAGE");
+            exit(1);
+        }
+#endif
+
+        if (test_config->attempts < 0) {
+            fprintf(
+                stderr,
+                "%s[ERROR] `attempts` need to be positive. Location: %s:%d%s\n",
+                RED,
+                test_config->filename,
+                test_config->line,
+                NORMAL);
+            exit(1); // NOLINT
+        }
+
+        if (test_config->timeout_ms < 0) {
+            fprintf(
+                stderr,
+                "%s[ERROR] `timeout_ms` need to be positive. Location: %s:%d%s\n",
+                RED,
+                test_config->filename,
+                test_config->line,
+                NORMAL);
+            exit(1); // NOLINT
+        }
+
+        if (test_config->attempts > ATTEST_MAX_TEST_ATTEMPTS) {
+            fprintf(
+                stderr,
+                "%s[ERROR] `attempts` need to be less than or equal to %d. Location: %s:%d%s\n",
+                RED,
+                ATTEST_MAX_TEST_ATTEMPTS,
+                test_config->filename,
+                test_config->line,
+                NORMAL);
+            exit(1); // NOLINT
+        }
+
+        if (test_config->test_title == NULL) {
+            fprintf(
+                stderr,
+                "%s[ERROR] Test case missing title. Location: %s:%d%s\n",
+                RED,
+                test_config->filename,
+                test_config->line,
+                NORMAL);
+            exit(1); // NOLINT
+        }
+
+        bool is_duplicate = !attest_insert_title(
+            attest_seen_titles,
+            title_slot_count,
+            test_config->test_title);
+
+        if (test_config->param_test == NULL && is_duplicate) {
+            fprintf(
+                stderr,
+                "%s[ERROR] Duplicate Test case title. Location: %s:%d%s\n",
+                RED,
+                test_config->filename,
+                test_config->line,
+                NORMAL);
+            exit(1); // NOLINT
+        }
+
+        test_count++;
+
+        // Selection happens in the same pass so the registry is only
+        // walked once.
+        // TODO: Discover behavior of a parameterize test with > 1 attempts sets.
+        bool is_selected = !test_config->disabled;
+
+        if (test_config->benchmark != NULL) {
+            is_selected = is_selected && attest_context.run_benches;
+        }
+
+        if (is_selected && attest_context.filter != NULL) {
+            is_selected = attest_glob_match(attest_context.filter, test_config->test_title);
+        }
+
+        if (is_selected && attest_impact != NULL) {
+            is_selected = attest_is_affected(test_config);
+        }
+
+        // With `--shard-cases` parameterized tests run on every shard
+        // and their cases are split instead.
+        bool is_split_by_case = attest_context.shard_cases && test_config->param_test_runner != NULL;
+        if (is_selected && attest_context.shard_count > 0 && !is_split_by_case) {
+            is_selected = attest_shard_of(test_config->test_title, test_config->filename, NULL)
+                == attest_context.shard_index;
+        }
+
+        if (is_selected && has_tags && test_config->tags[0] != NULL) {
+            test_config->tag_mask = attest_tag_mask(test_config);
+            is_selected = test_config->tag_mask != 0;
+            a_single_test_matched_the_tags = a_single_test_matched_the_tags || is_selected;
+        }
+
+        if (is_selected && test_config->benchmark != NULL) {
+            selected_bench_count++;
+            selected_tests[selected_capacity - selected_bench_count] = test_config;
+        } else if (is_selected) {
+            selected_tests[selected_count] = test_config;
+            selected_count++;
+        }
+
+        test_config = test_config->next;
+    }
+
+    // An empty shard is expected when there are more shards than tests.
+    if (attest_context.filter != NULL && attest_context.shard_count == 0 && attest_impact == NULL
+        && selected_count + selected_bench_count == 0) {
+        fprintf(stderr, "%s[ERROR] No tests matched `--filter=%s`.%s\n", RED, attest_context.filter, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    // Back to registration order.
+    TestConfig** selected_benches = selected_tests + selected_capacity - selected_bench_count;
+    for (int i = 0; i < selected_bench_count / 2; i++) {
+        TestConfig* bench = selected_benches[i];
+        selected_benches[i] = selected_benches[selected_bench_count - 1 - i];
+        selected_benches[selected_bench_count - 1 - i] = bench;
+    }
+
+    if (attest_context.shuffle) {
+        attest_shuffle_tests(selected_tests, selected_count);
+    }
+
+    if (attest_context.order == ATTEST_ORDER_FAILED_FIRST) {
+        attest_order_failed_first(selected_tests, selected_count);
+    }
+
+    if (attest_context.list_only) {
+        attest_list_tests(selected_tests, selected_count);
+        attest_list_tests(selected_benches, selected_bench_count);
+        attest_flush_output();
+        exit(0); // NOLINT
+    }
+
+    if (attest_context.baseline_path != NULL) {
+        if (!attest_context.update_baseline) {
+            attest_load_baseline(attest_context.baseline_path);
+        }
+
+        if (attest_context.update_baseline) {
+            attest_open_baseline(attest_context.baseline_path);
+        }
+    }
+
+#ifdef ATTEST_IMPACT
+    if (attest_context.impact_map_path != NULL && attest_impact == NULL) {
+        attest_open_impact_map(attest_context.impact_map_path);
+    }
+#endif
+
+    if (attest_context.history_path != NULL) {
+        attest_open_history(attest_context.history_path);
+    }
+
+    GlobalContext global_context = { .all = NULL };
+
+    if (attest_before_all_handler) {
+        attest_before_all_handler(&global_context);
+
+        if (global_context.all != NULL) {
+            attest_context.global_shared_data = global_context.all;
+        }
+    }
+
+    attest_report_start();
+
+    if ((attest_context.job_count > 1 && selected_count > 1) || attest_context.isolate) {
+#ifdef ATTEST_POSIX
+        attest_run_parallel(selected_tests, selected_count, attest_context.job_count);
+#endif
+    } else {
+#ifdef ATTEST_POSIX
+        AttestWorker isolated_worker = { .pid = -1, .test_index = -1 };
+#endif
+        for (int i = 0; i < selected_count; i++) {
+            if (attest_should_stop()) {
+                not_run_count = selected_count - i;
+                break;
+            }
+#ifdef ATTEST_POSIX
+            if (selected_tests[i]->isolated) {
+                attest_run_isolated(&isolated_worker, selected_tests, i);
+                continue;
+            }
+#endif
+            attest_run_test(selected_tests[i]);
+        }
+#ifdef ATTEST_POSIX
+        if (isolated_worker.pid > 0) {
+            attest_stop_worker(&isolated_worker);
+        }
+#endif
+    }
+
+    // Benchmarks run one at a time in this process, also with `--jobs`,
+    // so other tests don't skew their timings.
+    for (int i = 0; i < selected_bench_count; i++) {
+        if (attest_should_stop()) {
+            not_run_count += selected_bench_count - i;
+            break;
+        }
+        attest_run_test(selected_benches[i]);
+    }
+
+    if (has_tags && !a_single_test_matched_the_tags) {
+        attest_print("%sNo tests matched the selected tags.%s", RED, NORMAL);
+        attest_flush_output();
+        exit(1);
+    }
+
+    if (attest_after_all_handler) {
+        attest_after_all_handler(&global_context);
+    }
+
+    attest_teardown_fixtures(ATTEST_SCOPE_SUITE);
+    attest_teardown_fixtures(ATTEST_SCOPE_PROCESS);
+
+    if (attest_baseline_out != NULL) {
+        attest_close_baseline(attest_context.baseline_path);
+    }
+
+    free(attest_baseline);
+    free(attest_baseline_text);
+
+#ifdef ATTEST_IMPACT
+    if (attest_impact_out != NULL) {
+        attest_close_impact_map(attest_context.impact_map_path);
+    }
+#endif
+
+    if (attest_history_out != NULL) {
+        attest_close_history(attest_context.history_path);
+    }
+
+    report_summary();
+
+    return 0;
+}
+
+#ifndef ATTEST_NO_MAIN
+int main(int argc, char* argv[])
+{
+    return attest_main(argc, argv);
+}
+#endif
+
+/**************************
+ * REPORTERS
+ *************************/
+// Labels of array failures name the element where the arrays differ.
+void attest_render_label(char* buffer, const char* label, const FailureInfo* failure_info)
+{
+    int label_size = failure_info->has_index
+        ? snprintf(buffer, ATTEST_VALUE_BUF, "%s[%zu]", label, failure_info->index)
+        : snprintf(buffer, ATTEST_VALUE_BUF, "%s", label);
+
+    if (label_size >= ATTEST_VALUE_BUF) {
+        (void)sprintf(buffer, "(truncated)");
+    }
+}
+
+// Renders the window of an array or memory failure with the differing
+// byte or element in brackets, e.g. `... 61 62 [63] 64 ...`.
+int attest_render_window(char* buffer, const CapturedValue* value)
+{
+    int used = 0;
+    int element_size = value->kind == ATTEST_VALUE_BYTES ? 1 : value->element_size;
+
+    if (value->has_before) {
+        used += snprintf(buffer + used, ATTEST_VALUE_BUF - (size_t)used, "... ");
+    }
+
+    for (int i = 0; i < value->window_size / element_size && used < ATTEST_VALUE_BUF; i++) {
+        const char* open = i == value->window_mark ? "[" : "";
+        const char* close = i == value->window_mark ? "]" : "";
+        const char* space = i > 0 ? " " : "";
+        const unsigned char* element = value->window + (size_t)i * (size_t)element_size;
+
+        if (value->kind == ATTEST_VALUE_BYTES) {
+            used += snprintf(buffer + used, ATTEST_VALUE_BUF - (size_t)used, "%s%s%02x%s", space, open, *element, close);
+        } else if (element_size == (int)sizeof(float)) {
+            float element_value;
+            memcpy(&element_value, element, sizeof element_value);
+            used += snprintf(buffer + used, ATTEST_VALUE_BUF - (size_t)used, "%s%s%g%s", space, open, (double)element_value, close);
+        } else {
+            double element_value;
+            memcpy(&element_value, element, sizeof element_value);
+            used += snprintf(buffer + used, ATTEST_VALUE_BUF - (size_t)used, "%s%s%g%s", space, open, element_value, close);
+        }
+    }
+
+    if (value->has_after && used < ATTEST_VALUE_BUF) {
+        used += snprintf(buffer + used, ATTEST_VALUE_BUF - (size_t)used, " ...");
+    }
+
+    return used;
+}
+
+void attest_render_value(char* buffer, const CapturedValue* value)
+{
+    int value_size = 0;
+
+    switch (value->kind) {
+    case ATTEST_VALUE_INT:
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%lld", value->raw.as_int);
+        break;
+    case ATTEST_VALUE_UINT:
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%llu", value->raw.as_uint);
+        break;
+    case ATTEST_VALUE_NS:
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%lld ns", value->raw.as_int);
+        break;
+    case ATTEST_VALUE_CHAR:
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%c", (int)value->raw.as_int);
+        break;
+    case ATTEST_VALUE_PTR:
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%p", value->raw.as_ptr);
+        break;
+    case ATTEST_VALUE_STRING:
+#ifdef ATTEST_BORROW_STRINGS
+        value_size = snprintf(buffer, ATTEST_VALUE_BUF, "%s",
+            value->raw.as_string != NULL ? value->raw.as_string : "(null)");
+#else
+        value_size = value->is_truncated
+            ? ATTEST_VALUE_BUF
+            : snprintf(buffer, ATTEST_VALUE_BUF, "%s", value->retained);
+#endif
+        break;
+    case ATTEST_VALUE_BYTES:
+    case ATTEST_VALUE_FLOATS:
+        value_size = attest_render_window(buffer, value);
+        break;
+    }
+
+    if (value_size >= ATTEST_VALUE_BUF) {
+        (void)sprintf(buffer, "(truncated)");
+    } else if (value_size < 0) {
+        buffer[0] = '\0';
+    }
+}
+
+void attest_render_failure(const FailureInfo* failure_info, FailureText* text)
+{
+    int verification_size = failure_info->has_expected_value
+        ? snprintf(text->verification_text, ATTEST_VALUE_BUF, "%s(%s, %s)",
+              failure_info->verification,
+              failure_info->actual.label,
+              failure_info->expected.label)
+        : snprintf(text->verification_text, ATTEST_VALUE_BUF, "%s(%s)",
+              failure_info->verification,
+              failure_info->actual.label);
+
+    if (verification_size >= ATTEST_VALUE_BUF) {
+        (void)snprintf(text->verification_text, ATTEST_VALUE_BUF, "%s( truncated )",
+            failure_info->verification);
+    }
+
+    attest_render_label(text->actual_label, failure_info->actual.label, failure_info);
+    attest_render_value(text->actual_value, &failure_info->actual);
+
+    if (failure_info->has_expected_value) {
+        attest_render_label(text->expected_label, failure_info->expected.label, failure_info);
+        attest_render_value(text->expected_value, &failure_info->expected);
+    } else {
+        text->expected_label[0] = '\0';
+        text->expected_value[0] = '\0';
+    }
+}
+
+void display_failures(int test_attempt, char* failure_report_preamble)
+{
+    FailureList* failure_list = &failed_assertions_per_attempt[test_attempt];
+
+    for (size_t i = 0; i < failure_list->count; i++) {
+        FailureInfo* failure_info = &failure_list->failures[i];
+        FailureText failure_text;
+        attest_render_failure(failure_info, &failure_text);
+
+        bool is_last_failed_verification = i == failure_list->count - 1;
+        char* verification_preamble = is_last_failed_verification ? LEAF : BRANCH;
+
+        attest_print("%s%s%s%s %s@L%d: %s\n",
+            GRAY, failure_report_preamble, verification_preamble, NORMAL,
+            failure_info->filename, failure_info->line,
+            failure_text.verification_text);
+
+        char detail_preamble[7];
+        snprintf(detail_preamble, 7, "%s",
+            is_last_failed_verification ? "    " : TRUNK "  ");
+
+        bool actual_has_label = strcmp(failure_text.actual_label, failure_text.actual_value) != 0;
+        if (failure_info->has_expected_value) {
+
+            bool expected_has_label = strcmp(failure_text.expected_label, failure_text.expected_value) != 0;
+
+            if (actual_has_label) {
+                attest_print("%s%s%s%s %s = %s\n",
+                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
+                    failure_text.actual_label, failure_text.actual_value);
+            }
+
+            if (expected_has_label) {
+                attest_print("%s%s%s%s %s = %s\n",
+                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
+                    failure_text.expected_label, failure_text.expected_value);
+            }
+        } else {
+            if (actual_has_label) {
+                attest_print("%s%s%s%sActual: %s = %s\n",
+                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
+                    failure_text.actual_label, failure_text.actual_value);
+            }
+
+            attest_print("%s%s%s%sReason: %s\n",
+                GRAY, failure_report_preamble, detail_preamble, NORMAL,
+                failure_info->reason);
+        }
+
+        if (failure_info->has_msg) {
+            attest_print("%s%s%s%sMessage: %s%s\n",
+                GRAY, failure_report_preamble, detail_preamble, CYAN,
+                failure_info->msg, NORMAL);
+        }
+
+        attest_print("%s%s%s%s\n", GRAY, failure_report_preamble, detail_preamble, NORMAL);
+    }
+}
+
+// Name of a result in the machine readable formats.
+const char* attest_status_name(const TestConfig* test_config, Status status)
+{
+    if (test_config->skip) {
+        return "skipped";
+    }
+
+    switch (status) {
+    case PASSED:
+        return "passed";
+    case FAILED:
+        return "failed";
+    case TIMED_OUT:
+        return "timed_out";
+    case CRASHED:
+        return "crashed";
+    case MISSING_EXPECTATION:
+        return "missing_expectation";
+    }
+
+    return "unknown";
+}
+
+// Writes `text` escaped for a JSON string, or for XML text and
+// attributes when `as_xml` is set. Plain runs are copied in one piece.
+void attest_emit_escaped(const char* text, bool as_xml)
+{
+    if (text == NULL) {
+        return;
+    }
+
+    const char* run = text;
+
+    for (const char* cursor = text; *cursor != '\0'; cursor++) {
+        unsigned char c = (unsigned char)*cursor;
+        const char* replacement = NULL;
+        char control[8];
+
+        if (as_xml) {
+            switch (c) {
+            case '&':
+                replacement = "&amp;";
+                break;
+            case '<':
+                replacement = "&lt;";
+                break;
+            case '>':
+                replacement = "&gt;";
+                break;
+            case '"':
+                replacement = "&quot;";
+                break;
+            case '\'':
+                replacement = "&apos;";
+                break;
+            default:
+                // Control characters other than tab and newline are not valid XML.
+                if (c < 0x20 && c != '\n' && c != '\t') {
+                    replacement = "?";
+                }
+            }
+        } else {
+            switch (c) {
+            case '"':
+                replacement = "\\\"";
+                break;
+            case '\\':
+                replacement = "\\\\";
+                break;
+            case '\n':
+                replacement = "\\n";
+                break;
+            case '\t':
+                replacement = "\\t";
+                break;
+            case '\r':
+                replacement = "\\r";
+                break;
+            default:
+                if (c < 0x20) {
+                    (void)snprintf(control, sizeof control, "\\u%04x", c);
+                    replacement = control;
+                }
+            }
+        }
+
+        if (replacement != NULL) {
+            attest_write_output(run, (size_t)(cursor - run));
+            attest_write_output(replacement, strlen(replacement));
+            run = cursor + 1;
+        }
+    }
+
+    attest_write_output(run, strlen(run));
+}
+
+void attest_emit_json_string(const char* key, const char* value)
+{
+    attest_emit(",\"%s\":\"", key);
+    attest_emit_escaped(value, false);
+    attest_emit("\"");
+}
+
+void attest_emit_json_failure(const TestConfig* test_config, const FailureInfo* failure_info, int attempt, int case_number)
+{
+    FailureText text;
+    attest_render_failure(failure_info, &text);
+
+    attest_emit("{\"type\":\"failure\"");
+    attest_emit_json_string("title", test_config->test_title);
+    if (case_number > 0) {
+        attest_emit(",\"case\":%d", case_number);
+    } else {
+        attest_emit(",\"attempt\":%d", attempt);
+    }
+    attest_emit_json_string("file", failure_info->filename);
+    attest_emit(",\"line\":%d", failure_info->line);
+    attest_emit_json_string("verification", text.verification_text);
+    attest_emit_json_string("actual_label", text.actual_label);
+    attest_emit_json_string("actual", text.actual_value);
+    if (failure_info->has_expected_value) {
+        attest_emit_json_string("expected_label", text.expected_label);
+        attest_emit_json_string("expected", text.expected_value);
+    }
+    if (failure_info->has_msg) {
+        attest_emit_json_string("message", failure_info->msg);
+    }
+    if (failure_info->reason[0] != '\0') {
+        attest_emit_json_string("reason", failure_info->reason);
+    }
+    attest_emit("}\n");
+}
+
+#ifdef ATTEST_PERF_COUNTERS
+// Adds the counters that were read. With `ops` they are divided by it
+// and named per op.
+void attest_emit_perf(const PerfStats* stats, double ops)
+{
+    const char* names[4] = { "instructions", "cycles", "cache_misses", "branch_misses" };
+    long long values[4] = { stats->instructions, stats->cycles, stats->cache_misses, stats->branch_misses };
+
+    for (int i = 0; i < 4; i++) {
+        if (values[i] < 0) {
+            continue;
+        }
+
+        if (ops > 0) {
+            attest_emit(",\"%s_per_op\":%.3f", names[i], (double)values[i] / ops);
+        } else {
+            attest_emit(",\"%s\":%lld", names[i], values[i]);
+        }
+    }
+}
+#endif
+
+// One line for the test, then one per case and per failure.
+void attest_report_jsonl(const TestConfig* test_config, const char* reason)
+{
+    bool is_param_test = test_config->param_test_runner != NULL;
+    bool has_details = reason == NULL && !test_config->skip;
+
+    attest_emit("{\"type\":\"test\"");
+    attest_emit_json_string("title", test_config->test_title);
+    attest_emit_json_string("file", test_config->filename);
+    attest_emit(",\"line\":%d", test_config->line);
+    attest_emit_json_string("status", attest_status_name(test_config, test_config->status));
+    if (has_details && is_param_test) {
+        attest_emit(",\"cases\":%d", attest_cases_run);
+    } else if (has_details) {
+        attest_emit(",\"attempts\":%d", test_attempt_count);
+    }
+#ifdef ATTEST_TRACK_ALLOCS
+    if (has_details && !is_param_test) {
+        const AllocStats* stats = &test_config->alloc_stats;
+        attest_emit(
+            ",\"allocs\":%lld,\"frees\":%lld,\"alloc_bytes\":%lld,\"peak_bytes\":%lld,\"leaked_bytes\":%lld",
+            stats->allocs, stats->frees, stats->bytes, stats->peak_bytes, stats->leaked_bytes);
+    }
+#endif
+    if (has_details && test_config->benchmark && test_config->status == PASSED) {
+        const BenchStats* stats = &test_config->bench_stats;
+        attest_emit(
+            ",\"ns_per_op\":%.3f,\"median_ns\":%.3f,\"p99_ns\":%.3f,\"stddev_ns\":%.3f,"
+            "\"iterations\":%lld,\"samples\":%d",
+            stats->mean_ns, stats->median_ns, stats->p99_ns, stats->stddev_ns,
+            stats->iterations, stats->samples);
+#ifdef ATTEST_PERF_COUNTERS
+        attest_emit_perf(&stats->perf, (double)stats->samples * (double)stats->iterations);
+#endif
+    }
+#ifdef ATTEST_PERF_COUNTERS
+    if (has_details && !is_param_test) {
+        attest_emit_perf(&test_config->perf_stats, 0);
+    }
+#endif
+    attest_emit(",\"wall_ms\":%.3f,\"cpu_ms\":%.3f",
+        (double)test_config->wall_ns / 1e6,
+        (double)test_config->cpu_ns / 1e6);
+    if (reason != NULL) {
+        attest_emit_json_string("reason", reason);
+    }
+    attest_emit("}\n");
+
+    if (!has_details) {
+        return;
+    }
+
+    if (is_param_test) {
+        for (int i = 0; i < case_count; i++) {
+            InstanceResult* case_result = &parameterize_instance_results[i];
+
+            attest_emit("{\"type\":\"case\"");
+            attest_emit_json_string("title", test_config->test_title);
+            attest_emit(",\"case\":%d", case_result->case_index + 1);
+            attest_emit_json_string("name", case_result->case_name != NULL ? case_result->case_name : "");
+            attest_emit_json_string("status", attest_status_name(test_config, case_result->status));
+#ifdef ATTEST_PERF_COUNTERS
+            attest_emit_perf(&case_result->perf_stats, 0);
+#endif
+            attest_emit(",\"wall_ms\":%.3f,\"cpu_ms\":%.3f}\n",
+                (double)case_result->wall_ns / 1e6,
+                (double)case_result->cpu_ns / 1e6);
+
+            for (int j = 0; j < case_result->failure_count; j++) {
+                attest_emit_json_failure(test_config, &case_result->failures[j], 0, case_result->case_index + 1);
+            }
+        }
+        return;
+    }
+
+    for (int attempt = 0; attempt < test_attempt_count; attempt++) {
+        FailureList* failure_list = &failed_assertions_per_attempt[attempt];
+        for (size_t i = 0; i < failure_list->count; i++) {
+            attest_emit_json_failure(test_config, &failure_list->failures[i], attempt + 1, 0);
+        }
+    }
+}
+
+void attest_emit_tap_failure(const FailureInfo* failure_info, const char* indent, int attempt)
+{
+    FailureText text;
+    attest_render_failure(failure_info, &text);
+
+    attest_emit("%s- verification: \"", indent);
+    attest_emit_escaped(text.verification_text, false);
+    attest_emit("\"\n%s  file: \"", indent);
+    attest_emit_escaped(failure_info->filename, false);
+    attest_emit("\"\n%s  line: %d\n", indent, failure_info->line);
+    if (attempt > 0) {
+        attest_emit("%s  attempt: %d\n", indent, attempt);
+    }
+    attest_emit("%s  actual: \"", indent);
+    attest_emit_escaped(text.actual_value, false);
+    attest_emit("\"\n");
+    if (failure_info->has_expected_value) {
+        attest_emit("%s  expected: \"", indent);
+        attest_emit_escaped(text.expected_value, false);
+        attest_emit("\"\n");
+    }
+    if (failure_info->reason[0] != '\0') {
+        attest_emit("%s  reason: \"", indent);
+        attest_emit_escaped(failure_info->reason, false);
+        attest_emit("\"\n");
+    }
+    if (failure_info->has_msg) {
+        attest_emit("%s  message: \"", indent);
+        attest_emit_escaped(failure_info->msg, false);
+        attest_emit("\"\n");
+    }
+}
+
+// One test point per test. Tests that did not pass carry a YAML block
+// with their failures.
+void attest_report_tap(const TestConfig* test_config, const char* reason)
+{
+    bool is_ok = test_config->skip || (reason == NULL && test_config->status == PASSED);
+
+    attest_emit("%s - %s%s\n",
+        is_ok ? "ok" : "not ok",
+        test_config->test_title,
+        test_config->skip ? " # SKIP" : "");
+
+    if (is_ok) {
+        return;
+    }
+
+    attest_emit("  ---\n  status: %s\n  file: \"", attest_status_name(test_config, test_config->status));
+    attest_emit_escaped(test_config->filename, false);
+    attest_emit("\"\n  line: %d\n  duration_ms: %.3f\n",
+        test_config->line,
+        (double)test_config->wall_ns / 1e6);
+
+    if (reason != NULL) {
+        attest_emit("  reason: \"");
+        attest_emit_escaped(reason, false);
+        attest_emit("\"\n  ...\n");
+        return;
+    }
+
+    if (test_config->param_test_runner != NULL) {
+        attest_emit("  cases:\n");
+        for (int i = 0; i < case_count; i++) {
+            InstanceResult* case_result = &parameterize_instance_results[i];
+            if (case_result->status == PASSED) {
+                continue;
+            }
+
+            attest_emit("    - case: %d\n      name: \"", case_result->case_index + 1);
+            attest_emit_escaped(case_result->case_name, false);
+            attest_emit("\"\n      status: %s\n", attest_status_name(test_config, case_result->status));
+            if (case_result->failure_count > 0) {
+                attest_emit("      failures:\n");
+            }
+            for (int j = 0; j < case_result->failure_count; j++) {
+                attest_emit_tap_failure(&case_result->failures[j], "        ", 0);
+            }
+        }
+    } else {
+        attest_emit("  attempts: %d\n", test_attempt_count);
+        bool has_failures = false;
+        for (int attempt = 0; attempt < test_attempt_count; attempt++) {
+            FailureList* failure_list = &failed_assertions_per_attempt[attempt];
+            for (size_t i = 0; i < failure_list->count; i++) {
+                if (!has_failures) {
+                    attest_emit("  failures:\n");
+                    has_failures = true;
+                }
+                attest_emit_tap_failure(&failure_list->failures[i], "    ", attempt + 1);
             }
         }
+    }
 
-        printf(
-            "%s[FAIL]%s %s%s%s (%s%d/%d failed%s)\n",
-            BOLD_RED, NORMAL, BOLD_WHITE,
+    attest_emit("  ...\n");
+}
+
+void attest_emit_junit_failure_text(const FailureInfo* failure_info, int attempt)
+{
+    FailureText text;
+    attest_render_failure(failure_info, &text);
+
+    if (attempt > 0) {
+        attest_emit("Attempt %d: ", attempt);
+    }
+    attest_emit_escaped(failure_info->filename, true);
+    attest_emit(":%d: ", failure_info->line);
+    attest_emit_escaped(text.verification_text, true);
+    attest_emit("\n  ");
+    attest_emit_escaped(text.actual_label, true);
+    attest_emit(" = ");
+    attest_emit_escaped(text.actual_value, true);
+    attest_emit("\n");
+    if (failure_info->has_expected_value) {
+        attest_emit("  ");
+        attest_emit_escaped(text.expected_label, true);
+        attest_emit(" = ");
+        attest_emit_escaped(text.expected_value, true);
+        attest_emit("\n");
+    }
+    if (failure_info->reason[0] != '\0') {
+        attest_emit("  Reason: ");
+        attest_emit_escaped(failure_info->reason, true);
+        attest_emit("\n");
+    }
+    if (failure_info->has_msg) {
+        attest_emit("  Message: ");
+        attest_emit_escaped(failure_info->msg, true);
+        attest_emit("\n");
+    }
+}
+
+// Opens a <testcase> element, leaving the tag open for its result.
+void attest_open_junit_case(const char* class_name, const char* name, const char* filename, int line, long long wall_ns)
+{
+    attest_emit("    <testcase classname=\"");
+    attest_emit_escaped(class_name, true);
+    attest_emit("\" name=\"");
+    attest_emit_escaped(name, true);
+    attest_emit("\" file=\"");
+    attest_emit_escaped(filename, true);
+    attest_emit("\" line=\"%d\" time=\"%.6f\"", line, (double)wall_ns / 1e9);
+}
+
+// Closes a <testcase> with the element matching its status. Failures
+// of `failures` are listed in the body of a single <failure>.
+void attest_close_junit_case(Status status, const FailureInfo* failures, size_t failure_count, int attempt)
+{
+    switch (status) {
+    case PASSED:
+        attest_emit("/>\n");
+        return;
+    case TIMED_OUT:
+        attest_emit(">\n      <failure type=\"timed_out\" message=\"Timed out\"/>\n    </testcase>\n");
+        return;
+    case CRASHED:
+        attest_emit(">\n      <error message=\"Crashed\"/>\n    </testcase>\n");
+        return;
+    case MISSING_EXPECTATION:
+        attest_emit(">\n      <failure type=\"missing_expectation\" message=\"No expectation ran\"/>\n    </testcase>\n");
+        return;
+    case FAILED:
+        break;
+    }
+
+    attest_emit(">\n      <failure type=\"failed\" message=\"");
+    if (failure_count > 0) {
+        FailureText text;
+        attest_render_failure(&failures[0], &text);
+        attest_emit_escaped(text.verification_text, true);
+    }
+    attest_emit("\">");
+    for (size_t i = 0; i < failure_count; i++) {
+        attest_emit_junit_failure_text(&failures[i], attempt);
+    }
+    attest_emit("</failure>\n    </testcase>\n");
+}
+
+// One <testcase> per test, or per case of a parameterized test.
+void attest_report_junit(const TestConfig* test_config, const char* reason)
+{
+    bool is_param_test = test_config->param_test_runner != NULL;
+
+    if (reason != NULL || test_config->skip || !is_param_test) {
+        attest_open_junit_case(
+            test_config->filename,
             test_config->test_title,
-            NORMAL,
-            RED, amount_of_failed_cases, case_count, NORMAL);
+            test_config->filename,
+            test_config->line,
+            test_config->wall_ns);
+    }
+
+    if (reason != NULL) {
+        attest_emit(">\n      <error message=\"");
+        attest_emit_escaped(reason, true);
+        attest_emit("\"/>\n    </testcase>\n");
+        return;
+    }
+
+    if (test_config->skip) {
+        attest_emit(">\n      <skipped/>\n    </testcase>\n");
+        return;
+    }
+
+    if (is_param_test) {
+        for (int i = 0; i < case_count; i++) {
+            InstanceResult* case_result = &parameterize_instance_results[i];
+            char case_label[ATTEST_CASE_NAME_SIZE];
+
+            if (case_result->case_name == NULL || case_result->case_name[0] == '\0') {
+                (void)snprintf(case_label, sizeof case_label, "Case %d", case_result->case_index + 1);
+            } else {
+                (void)snprintf(case_label, sizeof case_label, "%s", case_result->case_name);
+            }
+
+            attest_open_junit_case(
+                test_config->test_title,
+                case_label,
+                test_config->filename,
+                test_config->line,
+                case_result->wall_ns);
+            attest_close_junit_case(
+                case_result->status,
+                case_result->failures,
+                (size_t)case_result->failure_count,
+                0);
+        }
+        return;
+    }
+
+    if (test_config->status != FAILED) {
+        attest_close_junit_case(test_config->status, NULL, 0, 0);
+        return;
+    }
+
+    // Only the last attempt decides a failed test, so its failures are
+    // the ones listed. Earlier attempts failed the same way or better.
+    int attempt = test_attempt_count - 1;
+    FailureList* failure_list = &failed_assertions_per_attempt[attempt];
+    attest_close_junit_case(
+        FAILED,
+        failure_list->failures,
+        failure_list->count,
+        test_attempt_count > 1 ? test_attempt_count : 0);
+}
+
+void attest_report_start(void)
+{
+    switch (attest_context.format) {
+    case ATTEST_FORMAT_JUNIT:
+        attest_emit("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n  <testsuite name=\"attest\">\n");
+        if (attest_context.shuffle) {
+            attest_emit("    <properties>\n      <property name=\"shuffle_seed\" value=\"%llu\"/>\n    </properties>\n",
+                attest_context.shuffle_seed);
+        }
+        break;
+    case ATTEST_FORMAT_TAP:
+        attest_emit("TAP version 13\n");
+        if (attest_context.shuffle) {
+            attest_emit("# Shuffled with --shuffle=%llu\n", attest_context.shuffle_seed);
+        }
+        break;
+    case ATTEST_FORMAT_TEXT:
+        // Printed first, so the seed survives a run that dies midway.
+        if (attest_context.shuffle) {
+            attest_emit("%sShuffled with --shuffle=%llu%s\n\n", CYAN, attest_context.shuffle_seed, NORMAL);
+        }
+        break;
+    case ATTEST_FORMAT_JSONL:
+        if (attest_context.shuffle) {
+            attest_emit("{\"type\":\"shuffle\",\"seed\":%llu}\n", attest_context.shuffle_seed);
+        }
+        break;
+    }
+}
+
+// Streams the result of a test that just finished. `reason` is set when
+// the test never reported back, e.g. its worker process died.
+void attest_report_record(TestConfig* test_config, const char* reason)
+{
+    switch (attest_context.format) {
+    case ATTEST_FORMAT_JUNIT:
+        attest_report_junit(test_config, reason);
+        break;
+    case ATTEST_FORMAT_JSONL:
+        attest_report_jsonl(test_config, reason);
+        break;
+    case ATTEST_FORMAT_TAP:
+        attest_report_tap(test_config, reason);
+        break;
+    case ATTEST_FORMAT_TEXT:
+        break;
+    }
+}
+
+void attest_report_end(void)
+{
+    switch (attest_context.format) {
+    case ATTEST_FORMAT_JUNIT:
+        attest_emit("  </testsuite>\n</testsuites>\n");
+        break;
+    case ATTEST_FORMAT_JSONL:
+        attest_emit(
+            "{\"type\":\"summary\",\"total\":%d,\"passed\":%d,\"skipped\":%d,\"failed\":%d,"
+            "\"missing_expectation\":%d,\"timed_out\":%d,\"crashed\":%d,\"not_run\":%d}\n",
+            total_tests, pass_count, skip_count, fail_count, empty_count, timeout_count, crash_count, not_run_count);
+        break;
+    case ATTEST_FORMAT_TAP:
+        attest_emit("1..%d\n", total_tests);
+        break;
+    case ATTEST_FORMAT_TEXT:
+        break;
+    }
+}
+
+// Output of `--list`. Plain lines of title and location, or one JSON
+// object per test with `--format=jsonl`.
+void attest_list_tests(TestConfig** selected_tests, int selected_count)
+{
+    for (int i = 0; i < selected_count; i++) {
+        TestConfig* test_config = selected_tests[i];
+
+        if (attest_context.format != ATTEST_FORMAT_JSONL) {
+            attest_emit("%s\t%s:%d\n", test_config->test_title, test_config->filename, test_config->line);
+            continue;
+        }
+
+        attest_emit("{\"type\":\"listed\"");
+        attest_emit_json_string("title", test_config->test_title);
+        attest_emit_json_string("file", test_config->filename);
+        attest_emit(",\"line\":%d,\"tags\":[", test_config->line);
+        for (int j = 0; j < ATTEST_MAX_TAGS && test_config->tags[j] != NULL; j++) {
+            attest_emit(j == 0 ? "\"" : ",\"");
+            attest_emit_escaped(test_config->tags[j], false);
+            attest_emit("\"");
+        }
+        attest_emit("]}\n");
+    }
+}
+
+void report_summary()
+{
+    attest_report_end();
+
+    attest_print("%s==============Test Summary==============%s\n", MAGENTA, NORMAL);
+    attest_print("%s  Total:          %d%s\n", MAGENTA, total_tests, NORMAL);
+    attest_print("%s  Passed:         %d%s\n", GREEN, pass_count, NORMAL);
+    attest_print("%s  Skipped:        %d%s\n", YELLOW, skip_count, NORMAL);
+    attest_print("%s  Failed:         %d%s\n", RED, fail_count, NORMAL);
+
+    if (empty_count) {
+        attest_print("%s  No assertions:  %d%s\n", CYAN, empty_count, NORMAL);
+    }
+
+    if (timeout_count) {
+        attest_print("%s  Timed out:      %d%s\n", RED, timeout_count, NORMAL);
+    }
+
+    if (crash_count) {
+        attest_print("%s  Crashed:        %d%s\n", RED, crash_count, NORMAL);
+    }
+
+    if (not_run_count > 0) {
+        attest_print("%s  Not run:        %d%s\n", YELLOW, not_run_count, NORMAL);
+    }
+
+    if (attest_context.requested_tag_count > 0) {
+        attest_print("%s  Ran tests with tags: ", CYAN);
+        for (int i = 0; i < attest_context.requested_tag_count; i++) {
+            bool is_last_tag = i == attest_context.requested_tag_count - 1;
+            if (is_last_tag) {
+                attest_print("%s\n%s", attest_context.requested_tags[i], NORMAL);
+            } else {
+                attest_print("%s, ", attest_context.requested_tags[i]);
+            }
+        }
+    }
+
+    if (attest_slowest_count > 0) {
+        attest_print("%s==============Slowest Tests=============%s\n", MAGENTA, NORMAL);
+        for (int i = 0; i < attest_slowest_count; i++) {
+            TimingRecord* record = &attest_slowest[i];
+
+            attest_print("%s  %8.3f ms%s %s(cpu %.3f ms)%s %s%s%s",
+                YELLOW, (double)record->wall_ns / 1e6, NORMAL,
+                GRAY, (double)record->cpu_ns / 1e6, NORMAL,
+                BOLD_WHITE, record->test_title, NORMAL);
+
+            if (record->case_index >= 0) {
+                if (record->case_name[0] != '\0') {
+                    attest_print(" [%s]", record->case_name);
+                } else {
+                    attest_print(" [Case %d]", record->case_index + 1);
+                }
+            }
+
+            attest_print(" %s%s:%d%s\n", GRAY, record->filename, record->line, NORMAL);
+        }
+    }
+
+    if (attest_flaky_count > 0) {
+        attest_print("%s===============Flaky Tests==============%s\n", MAGENTA, NORMAL);
+        for (int i = 0; i < attest_flaky_count; i++) {
+            FlakyRecord* record = &attest_flaky[i];
+
+            attest_print("%s  %5.1f%%%s %s(%d of %d runs)%s %s%s%s\n",
+                YELLOW, 100.0 * record->flaky_runs / record->run_count, NORMAL,
+                GRAY, record->flaky_runs, record->run_count, NORMAL,
+                BOLD_WHITE, record->title, NORMAL);
+        }
+    }
+
+    attest_flush_output();
+
+    exit(fail_count || empty_count || timeout_count || crash_count ? 1 : 0); // NOLINT
+}
+
+// Marks the attempt of `current_test` as passed unless an expectation
+// already failed.
+void attest_record_success(TestConfig* current_test)
+{
+    // A failure earlier in the attempt already decided the outcome.
+    if (current_test->status == MISSING_EXPECTATION) {
+        current_test->status = PASSED;
+    }
+
+    if (current_test->param_test && !parameterize_instance_results[current_test->param_index].has_status) {
+        InstanceResult* case_result = &parameterize_instance_results[current_test->param_index];
+        case_result->case_name = global_param_context.case_name;
+        case_result->has_status = true;
+        case_result->status = PASSED;
+    }
+}
+
+void attest_record_failure(TestConfig* current_test, const FailureInfo* failure_info)
+{
+    current_test->status = FAILED;
+
+    if (current_test->param_test) {
+        InstanceResult* case_result = &parameterize_instance_results[current_test->param_index];
+        case_result->has_status = true;
+        case_result->case_name = global_param_context.case_name;
+        case_result->status = FAILED;
+        FailureInfo* slot = attest_next_case_failure(case_result);
+        if (slot != NULL) {
+            *slot = *failure_info;
+        }
+    } else {
+        FailureInfo* slot = attest_next_attempt_failure(&failed_assertions_per_attempt[test_attempt_count]);
+        if (slot != NULL) {
+            *slot = *failure_info;
+        }
+
+        if (test_attempt_count >= attest_dirty_attempts) {
+            attest_dirty_attempts = test_attempt_count + 1;
+        }
+    }
+}
+
+#ifdef ATTEST_THREADS
+// Returns the buffer of the calling thread. A thread starts one with its
+// first expectation of a test.
+AttestThreadFailures* attest_own_thread_failures(void)
+{
+    unsigned epoch = __atomic_load_n(&attest_failure_epoch, __ATOMIC_ACQUIRE);
+
+    if (attest_own_failures != NULL && attest_own_epoch == epoch) {
+        return attest_own_failures;
+    }
+
+#ifdef ATTEST_GROWABLE_STORAGE
+    AttestThreadFailures* buffer = calloc(1, sizeof(AttestThreadFailures));
+
+    if (buffer == NULL) {
+        fprintf(stderr, "%s[ATTEST ERROR] Out of memory while recording an expectation.%s\n", RED, NORMAL);
+        exit(1); // NOLINT
+    }
+#else
+    int index = __atomic_fetch_add(&attest_thread_failures_used, 1, __ATOMIC_RELAXED);
+
+    if (index >= ATTEST_MAX_TEST_THREADS) {
+        fprintf(stderr,
+            "%s[ERROR] Reached max allowed threads recording expectations for a test. Define MACRO "
+            "ATTEST_MAX_TEST_THREADS to higher limit or define ATTEST_GROWABLE_STORAGE.%s\n",
+            RED, NORMAL);
+        exit(1); // NOLINT
+    }
+
+    AttestThreadFailures* buffer = &attest_thread_failure_pool[index];
+    buffer->list.count = 0;
+    buffer->passed = false;
+#endif
+
+    buffer->next = __atomic_load_n(&attest_thread_failures, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(
+        &attest_thread_failures, &buffer->next, buffer,
+        true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+
+    attest_own_failures = buffer;
+    attest_own_epoch = epoch;
+
+    return buffer;
+}
+
+// Moves the expectations of threads the test body started into `cfg`.
+// Runs on the thread of the test after the body returned, which is
+// where the body joined the threads it started.
+void attest_merge_thread_failures(TestConfig* cfg)
+{
+    AttestThreadFailures* buffer = __atomic_exchange_n(&attest_thread_failures, NULL, __ATOMIC_ACQUIRE);
+
+    if (ATTEST_LIKELY(buffer == NULL)) {
+        return;
+    }
+
+    (void)__atomic_add_fetch(&attest_failure_epoch, 1, __ATOMIC_RELEASE);
+
+    while (buffer != NULL) {
+        for (size_t i = 0; i < buffer->list.count; i++) {
+            attest_record_failure(cfg, &buffer->list.failures[i]);
+        }
+
+        if (buffer->passed) {
+            attest_record_success(cfg);
+        }
+
+        AttestThreadFailures* next = buffer->next;
+#ifdef ATTEST_GROWABLE_STORAGE
+        free(buffer->list.failures);
+        free(buffer);
+#endif
+        buffer = next;
+    }
+
+#ifndef ATTEST_GROWABLE_STORAGE
+    __atomic_store_n(&attest_thread_failures_used, 0, __ATOMIC_RELEASE);
+#endif
+}
+#endif
+
+void report_success()
+{
+    if (attest_property_probing) {
+        attest_first_success_pending = false;
+        attest_property_checked = true;
+        return;
+    }
+
+    TestConfig* current_test = attest_internal_current_test;
+
+#ifdef ATTEST_THREADS
+    if (current_test == NULL && __atomic_load_n(&attest_shared_test, __ATOMIC_ACQUIRE) != NULL) {
+        attest_own_thread_failures()->passed = true;
+        attest_first_success_pending = false;
+        return;
+    }
+#endif
+
+    if (current_test == NULL) {
+        fprintf(stderr, "[Attest Error] Reach unreachable state");
+        exit(1);
+    }
+
+    attest_first_success_pending = false;
+
+    attest_record_success(current_test);
+}
+
+void report_failure(const FailureInfo* failure_info)
+{
+    if (attest_property_probing) {
+        attest_property_failed = true;
+        return;
+    }
+
+#ifdef ATTEST_THREADS
+    if (attest_internal_current_test == NULL && __atomic_load_n(&attest_shared_test, __ATOMIC_ACQUIRE) != NULL) {
+        ATTEST_PAUSE_ALLOCS();
+        FailureInfo* slot = attest_next_attempt_failure(&attest_own_thread_failures()->list);
+        if (slot != NULL) {
+            *slot = *failure_info;
+        }
+        ATTEST_RESUME_ALLOCS();
+        return;
+    }
+#endif
+
+    if (attest_internal_current_test == NULL) {
+        fprintf(stderr, "[Attest Error] Reach unreachable state");
+        exit(1);
+    }
+
+    ATTEST_PAUSE_ALLOCS();
+    attest_record_failure(attest_internal_current_test, failure_info);
+    ATTEST_RESUME_ALLOCS();
+
+    if (attest_abort_armed) {
+        attest_abort_armed = false;
+        longjmp(attest_abort_jump, 1);
+    }
+}
+
+/**************************
+ * UTILITIES
+ *************************/
+
+bool has_status(Status target_status, const Status* statuses, int status_count)
+{
+    for (int i = 0; i < status_count; i++) {
+        if (statuses[i] == target_status) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        printf("%s%s%s\n", GRAY, TRUNK, NORMAL);
+bool any_instance(Status status)
+{
+    for (int i = 0; i < case_count; i++) {
+        if (parameterize_instance_results[i].status == status) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        for (int i = 0; i < amount_of_failed_cases; i++) {
-            bool is_last_failed_case = i == amount_of_failed_cases - 1;
-            InstanceResult* case_result = failed_cases[i];
+bool every_instance(Status status)
+{
+    for (int i = 0; i < case_count; i++) {
+        if (parameterize_instance_results[i].status != status) {
+            return false;
+        }
+    }
+    return true;
+}
 
-            printf(
-                "%s%s Case [%d]:%s %s%s%s\n",
-                GRAY,
-                is_last_failed_case ? LEAF : BRANCH,
-                i + 1,
-                NORMAL,
-                RED,
-                case_result->case_name[0] == '\0'
-                    ? "<unnamed>"
-                    : case_result->case_name,
-                NORMAL);
+AttestClock attest_clock_now(void)
+{
+#ifdef ATTEST_POSIX
+    struct timespec wall;
+    struct timespec cpu;
+    (void)clock_gettime(CLOCK_MONOTONIC, &wall);
+    (void)clock_gettime(attest_case_thread ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &cpu);
+
+    return (AttestClock) {
+        .wall_ns = (long long)wall.tv_sec * 1000000000LL + wall.tv_nsec,
+        .cpu_ns = (long long)cpu.tv_sec * 1000000000LL + cpu.tv_nsec
+    };
+#else
+    long long cpu_ns = (long long)clock() * (1000000000LL / CLOCKS_PER_SEC);
+    return (AttestClock) { .wall_ns = cpu_ns, .cpu_ns = cpu_ns };
+#endif
+}
 
-            for (int j = 0; j < case_result->failure_count; j++) {
-                bool is_last_failure = j == case_result->failure_count - 1;
+// Monotonic time without the CPU clock, for timing short stretches.
+long long attest_wall_now(void)
+{
+#ifdef ATTEST_POSIX
+    struct timespec wall;
+    (void)clock_gettime(CLOCK_MONOTONIC, &wall);
 
-                if (is_last_failed_case) {
-                    printf("    ");
-                } else {
-                    printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                }
+    return (long long)wall.tv_sec * 1000000000LL + wall.tv_nsec;
+#else
+    return (long long)clock() * (1000000000LL / CLOCKS_PER_SEC);
+#endif
+}
 
-                FailureInfo case_failure_info = case_result->failures[j];
-                printf(
-                    "%s%s%s %s@L%d: %s\n",
-                    GRAY,
-                    is_last_failure ? LEAF : BRANCH,
-                    NORMAL,
-                    case_failure_info.filename,
-                    case_failure_info.line,
-                    case_failure_info.verification_text);
+AttestClock attest_clock_since(AttestClock start)
+{
+    AttestClock now = attest_clock_now();
 
-                bool expected_has_label = strcmp(case_failure_info.expected_label, case_failure_info.expected_value) != 0;
-                if (case_failure_info.has_expected_value && expected_has_label) {
-                    if (is_last_failed_case) {
-                        printf("    ");
-                    } else {
-                        printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                    }
+    return (AttestClock) {
+        .wall_ns = now.wall_ns - start.wall_ns,
+        .cpu_ns = now.cpu_ns - start.cpu_ns
+    };
+}
 
-                    if (is_last_failure) {
-                        printf("    ");
-                    } else {
-                        printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                    }
+// Keeps the `--slowest` list sorted by inserting in place. The list
+// holds at most `slowest_limit` entries so this stays cheap. A
+// `case_name` is only copied once the record makes the list.
+void attest_record_timing(TimingRecord record, const char* case_name)
+{
+    int limit = attest_context.slowest_limit;
 
-                    printf("%s = %s\n", case_failure_info.expected_label, case_failure_info.expected_value);
-                }
+    if (limit == 0) {
+        return;
+    }
 
-                if (is_last_failed_case) {
-                    printf("    ");
-                } else {
-                    printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                }
+    if (attest_slowest_count == limit && record.wall_ns <= attest_slowest[limit - 1].wall_ns) {
+        return;
+    }
 
-                if (is_last_failure) {
-                    printf("    ");
-                } else {
-                    printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                }
+    int position = attest_slowest_count < limit ? attest_slowest_count : limit - 1;
 
-                bool actual_has_label = strcmp(case_failure_info.actual_label, case_failure_info.actual_value) != 0;
+    while (position > 0 && attest_slowest[position - 1].wall_ns < record.wall_ns) {
+        attest_slowest[position] = attest_slowest[position - 1];
+        position--;
+    }
 
-                if (actual_has_label) {
-                    printf("%s = %s\n", case_failure_info.actual_label, case_failure_info.actual_value);
-                }
+    attest_slowest[position] = record;
+    if (case_name != NULL) {
+        (void)snprintf(attest_slowest[position].case_name, sizeof attest_slowest[position].case_name, "%s", case_name);
+    }
 
-                if (case_failure_info.has_msg) {
-                    if (is_last_failed_case) {
-                        printf("    ");
-                    } else {
-                        printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                    }
+    if (attest_slowest_count < limit) {
+        attest_slowest_count++;
+    }
+}
 
-                    if (is_last_failure) {
-                        printf("    ");
-                    } else {
-                        printf("%s%s%s   ", GRAY, TRUNK, NORMAL);
-                    }
+void attest_vemit(const char* format, va_list args)
+{
+    size_t space = sizeof attest_output - attest_output_size;
 
-                    printf("%sMessage: %s%s\n", CYAN, case_failure_info.msg, NORMAL);
-                }
-                if (!is_last_failed_case && !is_last_failure) {
-                    printf("%s%s   %s%s\n", GRAY, TRUNK, TRUNK, NORMAL);
-                }
+    va_list retry;
+    va_copy(retry, args);
+    int needed = vsnprintf(attest_output + attest_output_size, space, format, args);
 
-                if (!is_last_failed_case && is_last_failure) {
-                    printf("%s%s%s   \n", GRAY, TRUNK, NORMAL);
-                }
+    if (needed >= 0 && (size_t)needed < space) {
+        attest_output_size += (size_t)needed;
+    } else if (needed >= 0) {
+        // The text did not fit behind what is already buffered. The partial
+        // copy is past attest_output_size so flushing drops it.
+        attest_flush_output();
 
-                if (is_last_failed_case && !is_last_failure) {
-                    printf("%s    %s%s\n", GRAY, TRUNK, NORMAL);
-                }
-            }
+        if ((size_t)needed < sizeof attest_output) {
+            attest_output_size = (size_t)vsnprintf(attest_output, sizeof attest_output, format, retry);
+        } else {
+#ifdef ATTEST_POSIX
+            (void)vdprintf(attest_output_fd, format, retry);
+#else
+            (void)vfprintf(stdout, format, retry);
+            (void)fflush(stdout);
+#endif
         }
     }
 
-    printf("\n");
+    va_end(retry);
+}
 
-    if (parameterize_after_all_cases != NULL) {
-        parameterize_after_all_cases(&global_param_context);
+// Output of the human readable reporter. Dropped when `--format`
+// selects a machine readable one.
+void attest_print(const char* format, ...)
+{
+    if (attest_context.format != ATTEST_FORMAT_TEXT) {
+        return;
     }
 
-    global_param_context.all = NULL;
-    global_param_context.set = NULL;
-    global_param_context.self = NULL;
-
-    parameterize_before_all_cases = NULL;
-    parameterize_after_all_cases = NULL;
-    case_count = 0;
+    va_list args;
+    va_start(args, format);
+    attest_vemit(format, args);
+    va_end(args);
+}
 
-    memset(parameterize_instance_results, 0, sizeof(InstanceResult) * ATTEST_MAX_TESTS);
+// Output of the machine readable reporters.
+void attest_emit(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    attest_vemit(format, args);
+    va_end(args);
 }
 
-int main(int argc, char* argv[])
+void attest_write_output(const char* bytes, size_t size)
 {
-    char* test_titles[ATTEST_MAX_TESTS];
-    int test_count = 0;
-    TestConfig* test_config = attest_registry_head;
+    if (size > sizeof attest_output - attest_output_size) {
+        attest_flush_output();
+    }
 
-    bool has_tags = false;
-    for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "--tag") == 0) {
-            if (i + 1 >= argc) {
-                fprintf(stderr,
-                    "[ERROR] Please pass a tag argument to `--tag`\n");
-                exit(1);
-            }
+    if (size >= sizeof attest_output) {
+#ifdef ATTEST_POSIX
+        (void)attest_write_all(attest_output_fd, bytes, size);
+#else
+        (void)fwrite(bytes, 1, size, stdout);
+        (void)fflush(stdout);
+#endif
+        return;
+    }
 
-            if (attest_context.requested_tag_count == ATTEST_MAX_TAGS) {
-                fprintf(stderr,
-                    "[ERROR] Reached max amount of tags. Please define `ATTEST_MAX_TAGS` to higher limit\n");
-                exit(1);
-            }
+    memcpy(attest_output + attest_output_size, bytes, size);
+    attest_output_size += size;
+}
 
-            strncpy(
-                attest_context.requested_tags[attest_context.requested_tag_count],
-                argv[i + 1],
-                20);
+void attest_flush_output(void)
+{
+    // Anything the test printed itself goes out ahead of its report.
+    (void)fflush(stdout);
 
-            attest_context.requested_tags[attest_context.requested_tag_count][20] = '\0';
-            attest_context.requested_tag_count++;
-            has_tags = true;
-        }
+    if (attest_output_size == 0) {
+        return;
     }
 
-    while (test_config) {
-        if (test_count == ATTEST_MAX_TESTS) {
-            fprintf(stderr,
-                "[ERROR] Reached max allowed tests. Define MACRO "
-                "ATTEST_MAX_TESTS to higher limit");
-            exit(1);
-        }
+#ifdef ATTEST_POSIX
+    (void)attest_write_all(attest_output_fd, attest_output, attest_output_size);
+#else
+    (void)fwrite(attest_output, 1, attest_output_size, stdout);
+    (void)fflush(stdout);
+#endif
 
-        if (test_config->attempts < 0) {
-            fprintf(
-                stderr,
-                "%s[ERROR] `attempts` need to be positive. Location: %s:%d%s\n",
-                RED,
-                test_config->filename,
-                test_config->line,
-                NORMAL);
-            exit(1); // NOLINT
-        }
+    attest_output_size = 0;
+}
 
-        if (test_config->attempts > ATTEST_MAX_TEST_ATTEMPTS) {
-            fprintf(
-                stderr,
-                "%s[ERROR] `attempts` need to be less than or equal to %d. Location: %s:%d%s\n",
-                RED,
-                ATTEST_MAX_TEST_ATTEMPTS,
-                test_config->filename,
-                test_config->line,
-                NORMAL);
-            exit(1); // NOLINT
-        }
+void attest_capture_int(CapturedValue* value, const char* label, long long raw)
+{
+    value->kind = ATTEST_VALUE_INT;
+    value->label = label;
+    value->raw.as_int = raw;
+}
 
-        if (test_config->test_title == NULL) {
-            fprintf(
-                stderr,
-                "%s[ERROR] Test case missing title. Location: %s:%d%s\n",
-                RED,
-                test_config->filename,
-                test_config->line,
-                NORMAL);
-            exit(1); // NOLINT
-        }
+void attest_capture_ns(CapturedValue* value, const char* label, long long raw)
+{
+    value->kind = ATTEST_VALUE_NS;
+    value->label = label;
+    value->raw.as_int = raw;
+}
 
-        if (test_config->param_test == NULL) {
-            for (int i = 0; i < test_count; i++) {
-                char* past_test_title = test_titles[i];
-                bool is_duplicate = strcmp(test_config->test_title, past_test_title) == 0;
-                if (is_duplicate) {
-                    fprintf(
-                        stderr,
-                        "%s[ERROR] Duplicate Test case title. Location: %s:%d%s\n",
-                        RED,
-                        test_config->filename,
-                        test_config->line,
-                        NORMAL);
-                    exit(1); // NOLINT
-                }
-            }
-        }
+void attest_capture_uint(CapturedValue* value, const char* label, unsigned long long raw)
+{
+    value->kind = ATTEST_VALUE_UINT;
+    value->label = label;
+    value->raw.as_uint = raw;
+}
 
-        test_titles[test_count] = test_config->test_title;
-        test_count++;
-        test_config = test_config->next;
-    }
+void attest_capture_char(CapturedValue* value, const char* label, int raw)
+{
+    value->kind = ATTEST_VALUE_CHAR;
+    value->label = label;
+    value->raw.as_int = raw;
+}
 
-    GlobalContext global_context = { .all = NULL };
+void attest_capture_ptr(CapturedValue* value, const char* label, const void* raw)
+{
+    value->kind = ATTEST_VALUE_PTR;
+    value->label = label;
+    value->raw.as_ptr = raw;
+}
 
-    if (attest_before_all_handler) {
-        attest_before_all_handler(&global_context);
+void attest_capture_string(CapturedValue* value, const char* label, const char* raw)
+{
+    value->kind = ATTEST_VALUE_STRING;
+    value->label = label;
+    value->raw.as_string = raw;
 
-        if (global_context.all != NULL) {
-            attest_context.global_shared_data = global_context.all;
-        }
+#ifndef ATTEST_BORROW_STRINGS
+    const char* source = raw != NULL ? raw : "(null)";
+    size_t length = 0;
+
+    while (length < ATTEST_VALUE_BUF - 1 && source[length] != '\0') {
+        value->retained[length] = source[length];
+        length++;
     }
 
-    test_config = attest_registry_head;
+    value->retained[length] = '\0';
+    value->is_truncated = source[length] != '\0';
+#endif
+}
 
-    bool a_single_test_matched_the_tags = false;
+// A site is the file, verification, labels and reason of an
+// expectation in one string literal, split by NUL. It costs a call site
+// a single address and no relocation. Expectations on a single value
+// have an empty expected label.
+void attest_read_site(const char* site, FailureInfo* failure_info)
+{
+    const char* parts[5];
 
-    // TODO: Discover behavior of a parameterize test with > 1 attempts sets.
-    while (test_config) {
-        if (test_config->disabled) {
-            test_config = test_config->next;
-            continue;
-        }
+    for (int i = 0; i < 5; i++) {
+        parts[i] = site;
+        site += strlen(site) + 1;
+    }
 
-        if (has_tags && test_config->tags[0] != NULL) {
-            bool test_has_requested_tag = false;
+    failure_info->filename = (char*)parts[0];
+    failure_info->verification = parts[1];
+    failure_info->actual.label = parts[2];
+    failure_info->expected.label = parts[3];
+    failure_info->has_expected_value = parts[3][0] != '\0';
+    failure_info->reason = parts[4];
+}
 
-            for (int i = 0; i < attest_context.requested_tag_count; i++) {
-                char* requested_tag = attest_context.requested_tags[i];
-                for (int j = 0; j < ATTEST_MAX_TAGS && test_config->tags[j] != NULL; j++) {
-                    char* test_tag = test_config->tags[j];
-                    if (strcmp(test_tag, requested_tag) == 0) {
-                        test_has_requested_tag = true;
-                    }
-                }
-            }
+// Fills the rest of a failure from its message and reports it.
+void attest_fail_at(FailureInfo* failure_info, int line, const char* format, va_list args)
+{
+    failure_info->line = line;
+    failure_info->has_msg = false;
 
-            if (test_has_requested_tag) {
-                a_single_test_matched_the_tags = true;
-            } else {
-                test_config = test_config->next;
-                continue;
-            }
-        }
+    if (format != NULL) {
+        int msg_size = vsnprintf(failure_info->msg, ATTEST_VALUE_BUF, format, args);
+        failure_info->has_msg = msg_size != 0;
 
-        if (test_config->param_test_runner) {
-            run_parameterize_test(test_config);
-        } else {
-            attest_internal_current_test = test_config;
-            attester();
-            attest_internal_current_test = NULL;
+        if (msg_size >= ATTEST_VALUE_BUF) {
+            (void)snprintf(failure_info->msg, ATTEST_VALUE_BUF, "(truncated)");
+        } else if (msg_size < 0) {
+            (void)snprintf(failure_info->msg, ATTEST_VALUE_BUF, "[ERROR] Unable to format message");
         }
+    }
 
-        memset(failed_assertions_per_attempt, 0, sizeof failed_assertions_per_attempt);
+    report_failure(failure_info);
+}
 
-        total_tests++;
+void attest_fail_int(const char* site, int line, long long actual, long long expected, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
 
-        test_config = test_config->next;
-    }
+    attest_read_site(site, &failure_info);
+    attest_capture_int(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_int(&failure_info.expected, failure_info.expected.label, expected);
 
-    if (has_tags && !a_single_test_matched_the_tags) {
-        printf("%sNo tests matched the selected tags.%s", RED, NORMAL);
-        exit(1);
-    }
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
 
-    if (attest_after_all_handler) {
-        attest_after_all_handler(&global_context);
-    }
+void attest_fail_uint(const char* site, int line, unsigned long long actual, unsigned long long expected, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
 
-    report_summary();
+    attest_read_site(site, &failure_info);
+    attest_capture_uint(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_uint(&failure_info.expected, failure_info.expected.label, expected);
 
-    return 0;
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
 }
 
-/**************************
- * REPORTERS
- *************************/
-void display_failures(int test_attempt, char* failure_report_preamble)
+void attest_fail_char(const char* site, int line, int actual, int expected, const char* format, ...)
 {
-    FailureList* failure_list = &failed_assertions_per_attempt[test_attempt];
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
 
-    for (size_t i = 0; i < failure_list->count; i++) {
-        FailureInfo* failure_info = &failure_list->failures[i];
-        bool is_last_failed_verification = i == failure_list->count - 1;
-        char* verification_preamble = is_last_failed_verification ? LEAF : BRANCH;
+    attest_read_site(site, &failure_info);
+    attest_capture_char(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_char(&failure_info.expected, failure_info.expected.label, expected);
 
-        printf("%s%s%s%s %s@L%d: %s\n",
-            GRAY, failure_report_preamble, verification_preamble, NORMAL,
-            failure_info->filename, failure_info->line,
-            failure_info->verification_text);
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
 
-        char detail_preamble[7];
-        snprintf(detail_preamble, 7, "%s",
-            is_last_failed_verification ? "    " : TRUNK "  ");
+void attest_fail_ptr(const char* site, int line, const void* actual, const void* expected, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
+
+    attest_read_site(site, &failure_info);
+    attest_capture_ptr(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_ptr(&failure_info.expected, failure_info.expected.label, expected);
+
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
+
+void attest_fail_string(const char* site, int line, const char* actual, const char* expected, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
 
-        bool actual_has_label = strcmp(failure_info->actual_label, failure_info->actual_value) != 0;
-        if (failure_info->has_expected_value) {
+    attest_read_site(site, &failure_info);
+    attest_capture_string(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_string(&failure_info.expected, failure_info.expected.label, expected);
 
-            bool expected_has_label = strcmp(failure_info->expected_label, failure_info->expected_value) != 0;
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
 
-            if (actual_has_label) {
-                printf("%s%s%s%s %s = %s\n",
-                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
-                    failure_info->actual_label, failure_info->actual_value);
-            }
+void attest_fail_ns(const char* site, int line, long long actual, long long expected, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
 
-            if (expected_has_label) {
-                printf("%s%s%s%s %s = %s\n",
-                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
-                    failure_info->expected_label, failure_info->expected_value);
-            }
-        } else {
-            if (actual_has_label) {
-                printf("%s%s%s%sActual: %s = %s\n",
-                    GRAY, failure_report_preamble, detail_preamble, NORMAL,
-                    failure_info->actual_label, failure_info->actual_value);
-            }
+    attest_read_site(site, &failure_info);
+    attest_capture_ns(&failure_info.actual, failure_info.actual.label, actual);
+    attest_capture_ns(&failure_info.expected, failure_info.expected.label, expected);
 
-            printf("%s%s%s%sReason: %s\n",
-                GRAY, failure_report_preamble, detail_preamble, NORMAL,
-                failure_info->reason);
-        }
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
 
-        if (failure_info->has_msg) {
-            printf("%s%s%s%sMessage: %s%s\n",
-                GRAY, failure_report_preamble, detail_preamble, CYAN,
-                failure_info->msg, NORMAL);
+// Offset of the first byte that differs in a block known to differ.
+size_t attest_first_difference_in(const unsigned char* actual, const unsigned char* expected, size_t offset, size_t end)
+{
+#if defined(ATTEST_SIMD_AVX2)
+    for (; offset + 32 <= end; offset += 32) {
+        __m256i same = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i*)(actual + offset)),
+            _mm256_loadu_si256((const __m256i*)(expected + offset)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(same);
+        if (mask != 0xFFFFFFFFu) {
+            return offset + (size_t)__builtin_ctz(~mask);
+        }
+    }
+#elif defined(ATTEST_SIMD_SSE2)
+    for (; offset + 16 <= end; offset += 16) {
+        __m128i same = _mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i*)(actual + offset)),
+            _mm_loadu_si128((const __m128i*)(expected + offset)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(same);
+        if (mask != 0xFFFFu) {
+            return offset + (size_t)__builtin_ctz(~mask);
+        }
+    }
+#elif defined(ATTEST_SIMD_NEON)
+    for (; offset + 16 <= end; offset += 16) {
+        uint64x2_t same = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(actual + offset), vld1q_u8(expected + offset)));
+        if ((vgetq_lane_u64(same, 0) & vgetq_lane_u64(same, 1)) != ~0ULL) {
+            break;
         }
+    }
+#endif
 
-        printf("%s%s%s%s\n", GRAY, failure_report_preamble, detail_preamble, NORMAL);
+    while (offset < end && actual[offset] == expected[offset]) {
+        offset++;
     }
+    return offset;
 }
 
-void report_summary()
+// Offset of the first byte that differs, or `size` when none does. The
+// blocks go through memcmp, which libc picks the widest vector unit of
+// the machine for at run time, and only the block with the difference
+// is scanned again.
+size_t attest_first_difference(const unsigned char* actual, const unsigned char* expected, size_t size)
 {
-    printf("%s==============Test Summary==============%s\n", MAGENTA, NORMAL);
-    printf("%s  Total:          %d%s\n", MAGENTA, total_tests, NORMAL);
-    printf("%s  Passed:         %d%s\n", GREEN, pass_count, NORMAL);
-    printf("%s  Skipped:        %d%s\n", YELLOW, skip_count, NORMAL);
-    printf("%s  Failed:         %d%s\n", RED, fail_count, NORMAL);
+    size_t block_size = 4096;
 
-    if (empty_count) {
-        printf("%s  No assertions:  %d%s\n", CYAN, empty_count, NORMAL);
-    }
+    for (size_t offset = 0; offset < size; offset += block_size) {
+        size_t length = size - offset < block_size ? size - offset : block_size;
 
-    if (attest_context.requested_tag_count > 0) {
-        printf("%s  Ran tests with tags: ", CYAN);
-        for (int i = 0; i < attest_context.requested_tag_count; i++) {
-            bool is_last_tag = i == attest_context.requested_tag_count - 1;
-            if (is_last_tag) {
-                printf("%s\n%s", attest_context.requested_tags[i], NORMAL);
-            } else {
-                printf("%s, ", attest_context.requested_tags[i]);
-            }
+        if (memcmp(actual + offset, expected + offset, length) != 0) {
+            return attest_first_difference_in(actual, expected, offset, offset + length);
         }
     }
 
-    exit(fail_count || empty_count ? 1 : 0); // NOLINT
+    return size;
 }
 
-void report_success()
+// Whether a pair in `[start, end)` is further apart than `tolerance`.
+// The vector loops keep one mask of the lanes that held, so a block
+// costs no branch per element. NaN is never near, infinities are near
+// themselves, as in the scalar loop.
+bool attest_block_far_float(const float* actual, const float* expected, size_t start, size_t end, float tolerance)
 {
-    if (attest_internal_current_test == NULL) {
-        fprintf(stderr, "[Attest Error] Reach unreachable state");
-        exit(1);
+    size_t i = start;
+    bool is_far = false;
+
+#if defined(ATTEST_SIMD_AVX2)
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 limit = _mm256_set1_ps(tolerance);
+    __m256 held = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (; i + 8 <= end; i += 8) {
+        __m256 left = _mm256_loadu_ps(actual + i);
+        __m256 right = _mm256_loadu_ps(expected + i);
+        __m256 distance = _mm256_andnot_ps(sign, _mm256_sub_ps(left, right));
+        held = _mm256_and_ps(held,
+            _mm256_or_ps(_mm256_cmp_ps(left, right, _CMP_EQ_OQ), _mm256_cmp_ps(distance, limit, _CMP_LE_OQ)));
     }
+    is_far = _mm256_movemask_ps(held) != 0xFF;
+#elif defined(ATTEST_SIMD_SSE2)
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 limit = _mm_set1_ps(tolerance);
+    __m128 held = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (; i + 4 <= end; i += 4) {
+        __m128 left = _mm_loadu_ps(actual + i);
+        __m128 right = _mm_loadu_ps(expected + i);
+        __m128 distance = _mm_andnot_ps(sign, _mm_sub_ps(left, right));
+        held = _mm_and_ps(held, _mm_or_ps(_mm_cmpeq_ps(left, right), _mm_cmple_ps(distance, limit)));
+    }
+    is_far = _mm_movemask_ps(held) != 0xF;
+#elif defined(ATTEST_SIMD_NEON)
+    float32x4_t limit = vdupq_n_f32(tolerance);
+    uint32x4_t held = vdupq_n_u32(0xFFFFFFFFu);
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t left = vld1q_f32(actual + i);
+        float32x4_t right = vld1q_f32(expected + i);
+        held = vandq_u32(held, vorrq_u32(vceqq_f32(left, right), vcleq_f32(vabdq_f32(left, right), limit)));
+    }
+    uint32x2_t halves = vand_u32(vget_low_u32(held), vget_high_u32(held));
+    is_far = (vget_lane_u32(halves, 0) & vget_lane_u32(halves, 1)) != 0xFFFFFFFFu;
+#endif
 
-    TestConfig* current_test = attest_internal_current_test;
-
-    current_test->status = PASSED;
-
-    if (current_test->attempts > 0) {
-        printf(
-            "%s ->%s %sAttempt %d:%s %sPassed%s\n",
-            GRAY, NORMAL, CYAN,
-            current_test->attempt_count + 1,
-            NORMAL,
-            GREEN,
-            NORMAL);
-    } else if (current_test->param_test && !parameterize_instance_results[current_test->param_index].has_status) {
-        parameterize_instance_results[current_test->param_index] = (InstanceResult) {
-            .case_name = global_param_context.case_name,
-            .has_status = true,
-            .status = PASSED
-        };
+    for (; i < end; i++) {
+        float distance = actual[i] > expected[i] ? actual[i] - expected[i] : expected[i] - actual[i];
+        is_far |= !(actual[i] == expected[i] || distance <= tolerance);
     }
+
+    return is_far;
 }
 
-void report_failure(FailureInfo failure_info)
+bool attest_block_far_double(const double* actual, const double* expected, size_t start, size_t end, double tolerance)
 {
-    if (attest_internal_current_test == NULL) {
-        fprintf(stderr, "[Attest Error] Reach unreachable state");
-        exit(1);
+    size_t i = start;
+    bool is_far = false;
+
+#if defined(ATTEST_SIMD_AVX2)
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d limit = _mm256_set1_pd(tolerance);
+    __m256d held = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (; i + 4 <= end; i += 4) {
+        __m256d left = _mm256_loadu_pd(actual + i);
+        __m256d right = _mm256_loadu_pd(expected + i);
+        __m256d distance = _mm256_andnot_pd(sign, _mm256_sub_pd(left, right));
+        held = _mm256_and_pd(held,
+            _mm256_or_pd(_mm256_cmp_pd(left, right, _CMP_EQ_OQ), _mm256_cmp_pd(distance, limit, _CMP_LE_OQ)));
     }
+    is_far = _mm256_movemask_pd(held) != 0xF;
+#elif defined(ATTEST_SIMD_SSE2)
+    __m128d sign = _mm_set1_pd(-0.0);
+    __m128d limit = _mm_set1_pd(tolerance);
+    __m128d held = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (; i + 2 <= end; i += 2) {
+        __m128d left = _mm_loadu_pd(actual + i);
+        __m128d right = _mm_loadu_pd(expected + i);
+        __m128d distance = _mm_andnot_pd(sign, _mm_sub_pd(left, right));
+        held = _mm_and_pd(held, _mm_or_pd(_mm_cmpeq_pd(left, right), _mm_cmple_pd(distance, limit)));
+    }
+    is_far = _mm_movemask_pd(held) != 0x3;
+#elif defined(ATTEST_SIMD_NEON) && defined(__aarch64__)
+    // Armv7 NEON has no double lanes.
+    float64x2_t limit = vdupq_n_f64(tolerance);
+    uint64x2_t held = vdupq_n_u64(~0ULL);
+    for (; i + 2 <= end; i += 2) {
+        float64x2_t left = vld1q_f64(actual + i);
+        float64x2_t right = vld1q_f64(expected + i);
+        held = vandq_u64(held, vorrq_u64(vceqq_f64(left, right), vcleq_f64(vabdq_f64(left, right), limit)));
+    }
+    is_far = (vgetq_lane_u64(held, 0) & vgetq_lane_u64(held, 1)) != ~0ULL;
+#endif
 
-    attest_internal_current_test->status = FAILED;
-
-    if (attest_internal_current_test->param_test) {
-        InstanceResult* case_result = &parameterize_instance_results[attest_internal_current_test->param_index];
-        case_result->has_status = true;
-        case_result->case_name = global_param_context.case_name;
-        case_result->status = FAILED;
-        case_result->failures[case_result->failure_count] = failure_info;
-        case_result->failure_count++;
-    } else {
-        FailureList* failure_list = &failed_assertions_per_attempt[test_attempt_count];
-        failure_list->failures[failure_list->count] = failure_info;
-        failure_list->count++;
+    for (; i < end; i++) {
+        double distance = actual[i] > expected[i] ? actual[i] - expected[i] : expected[i] - actual[i];
+        is_far |= !(actual[i] == expected[i] || distance <= tolerance);
     }
-}
 
-/**************************
- * UTILITIES
- *************************/
+    return is_far;
+}
 
-bool has_status(Status target_status, const Status* statuses, int status_count)
+// Index of the first pair further apart than `tolerance`, or `count`.
+// Only a block with a miss is checked again, element by element.
+size_t attest_first_far_float(const float* actual, const float* expected, size_t count, float tolerance)
 {
-    for (int i = 0; i < status_count; i++) {
-        if (statuses[i] == target_status) {
-            return true;
+    size_t block_size = 256;
+
+    for (size_t start = 0; start < count; start += block_size) {
+        size_t end = count - start < block_size ? count : start + block_size;
+
+        if (!attest_block_far_float(actual, expected, start, end, tolerance)) {
+            continue;
+        }
+
+        for (size_t i = start; i < end; i++) {
+            float distance = actual[i] > expected[i] ? actual[i] - expected[i] : expected[i] - actual[i];
+            if (!(actual[i] == expected[i] || distance <= tolerance)) {
+                return i;
+            }
         }
     }
-    return false;
+
+    return count;
 }
 
-bool any_instance(Status status)
+size_t attest_first_far_double(const double* actual, const double* expected, size_t count, double tolerance)
 {
-    for (int i = 0; i < case_count; i++) {
-        if (parameterize_instance_results[i].status == status) {
-            return true;
+    size_t block_size = 256;
+
+    for (size_t start = 0; start < count; start += block_size) {
+        size_t end = count - start < block_size ? count : start + block_size;
+
+        if (!attest_block_far_double(actual, expected, start, end, tolerance)) {
+            continue;
+        }
+
+        for (size_t i = start; i < end; i++) {
+            double distance = actual[i] > expected[i] ? actual[i] - expected[i] : expected[i] - actual[i];
+            if (!(actual[i] == expected[i] || distance <= tolerance)) {
+                return i;
+            }
         }
     }
-    return false;
+
+    return count;
 }
 
-bool every_instance(Status status)
+// Copies the window of `ATTEST_DIFF_WINDOW` bytes around `mark`, both
+// counted in units of `unit` bytes.
+void attest_capture_window(CapturedValue* value, const void* raw, size_t count, size_t unit, size_t mark)
 {
-    for (int i = 0; i < case_count; i++) {
-        if (parameterize_instance_results[i].status != status) {
-            return false;
-        }
+    size_t window_count = ATTEST_DIFF_WINDOW / unit > 0 ? ATTEST_DIFF_WINDOW / unit : 1;
+    size_t start = mark > window_count / 2 ? mark - window_count / 2 : 0;
+
+    if (count >= window_count && start > count - window_count) {
+        start = count - window_count;
     }
-    return true;
+
+    size_t end = start + window_count < count ? start + window_count : count;
+    size_t size = (end - start) * unit < ATTEST_DIFF_WINDOW ? (end - start) * unit : ATTEST_DIFF_WINDOW;
+
+    memcpy(value->window, (const unsigned char*)raw + start * unit, size);
+    value->raw.as_ptr = raw;
+    value->window_size = (int)size;
+    value->window_mark = (int)(mark - start);
+    value->element_size = (int)unit;
+    value->has_before = start > 0;
+    value->has_after = end < count;
+}
+
+void attest_fail_memory(const char* site, int line, const void* actual, const void* expected,
+    size_t size, size_t element_size, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
+    size_t offset = attest_first_difference(actual, expected, size);
+
+    attest_read_site(site, &failure_info);
+    failure_info.actual.kind = ATTEST_VALUE_BYTES;
+    failure_info.expected.kind = ATTEST_VALUE_BYTES;
+    attest_capture_window(&failure_info.actual, actual, size, 1, offset);
+    attest_capture_window(&failure_info.expected, expected, size, 1, offset);
+    failure_info.has_index = true;
+    failure_info.index = offset / element_size;
+
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
+}
+
+void attest_fail_near(const char* site, int line, const void* actual, const void* expected,
+    size_t count, size_t element_size, size_t index, const char* format, ...)
+{
+    FailureInfo failure_info = { .has_msg = false };
+    va_list args;
+
+    attest_read_site(site, &failure_info);
+    failure_info.actual.kind = ATTEST_VALUE_FLOATS;
+    failure_info.expected.kind = ATTEST_VALUE_FLOATS;
+    attest_capture_window(&failure_info.actual, actual, count, element_size, index);
+    attest_capture_window(&failure_info.expected, expected, count, element_size, index);
+    failure_info.has_index = true;
+    failure_info.index = index;
+
+    va_start(args, format);
+    attest_fail_at(&failure_info, line, format, args);
+    va_end(args);
 }
 
 /**************************
@@ -979,6 +7475,96 @@ bool every_instance(Status status)
     }                                                              \
     static void name(TestContext* ctx)
 
+#define BENCH(name, ...)                                           \
+    static inline void name(void);                                 \
+    static void name##_bench(TestContext* context)                 \
+    {                                                              \
+        (void)context;                                             \
+        name();                                                    \
+    }                                                              \
+    static void __attribute__((constructor)) register_##name(void) \
+    {                                                              \
+        static TestConfig test_config = {                          \
+            .filename = __FILE__,                                  \
+            .line = __LINE__,                                      \
+            .test_title = #name,                                   \
+            .benchmark = name##_bench,                         \
+            __VA_ARGS__                                            \
+        };                                                         \
+        attest_update_registry(&test_config);                      \
+    }                                                              \
+    static inline void name(void)
+
+#define BENCH_CTX(name, ctx, ...)                                  \
+    static void name(TestContext* ctx);                            \
+    static void __attribute__((constructor)) register_##name(void) \
+    {                                                              \
+        static TestConfig test_config = {                          \
+            .filename = __FILE__,                                  \
+            .line = __LINE__,                                      \
+            .test_title = #name,                                   \
+            .benchmark = name,                                 \
+            __VA_ARGS__                                            \
+        };                                                         \
+        attest_update_registry(&test_config);                      \
+    }                                                              \
+    static void name(TestContext* ctx)
+
+#define PROPERTY_TEST(name, ...)                                   \
+    static void name(void);                                        \
+    static void __attribute__((constructor)) register_##name(void) \
+    {                                                              \
+        static TestConfig test_config = {                          \
+            .filename = __FILE__,                                  \
+            .line = __LINE__,                                      \
+            .test_title = #name,                                   \
+            .property = name,                                      \
+            __VA_ARGS__                                            \
+        };                                                         \
+        attest_update_registry(&test_config);                      \
+    }                                                              \
+    static void name(void)
+
+// Generators of `PROPERTY_TEST`. Inputs shrink towards 0, or the bound
+// of the range closest to it, and towards short buffers of 'a's or zeros.
+#define GEN_RANGE(min, max) attest_gen_range((long long)(min), (long long)(max))
+
+#define GEN_INT() ((int)attest_gen_range(INT_MIN, INT_MAX))
+
+#define GEN_BYTES(buffer, max_size) attest_gen_bytes((unsigned char*)(buffer), (size_t)(max_size))
+
+#define GEN_STRING(buffer, max_length) attest_gen_string((buffer), (size_t)(max_length))
+
+// Keeps the compiler from optimizing away a value a benchmark computes.
+#if defined(__GNUC__) || defined(__clang__)
+#define DO_NOT_OPTIMIZE(value) __asm__ volatile("" : : "r,m"(value) : "memory")
+#else
+#define DO_NOT_OPTIMIZE(value)                              \
+    do {                                                    \
+        static volatile long long attest_sink;              \
+        attest_sink = (long long)(value);                   \
+    } while (0)
+#endif
+
+// Builds a value the tests share. The body returns it the first time
+// `USE_FIXTURE(title)` asks for it in its scope.
+#define FIXTURE(title, ...)                                                  \
+    static void* title##_fixture_setup(void);                                \
+    static AttestFixture title##_fixture = {                                 \
+        .name = #title,                                                      \
+        .setup = title##_fixture_setup,                                      \
+        __VA_ARGS__                                                          \
+    };                                                                       \
+    static void __attribute__((constructor)) register_##title##_fixture(void) \
+    {                                                                        \
+        attest_register_fixture(&title##_fixture);                           \
+    }                                                                        \
+    static void* title##_fixture_setup(void)
+
+// With workers the first use of a process scoped fixture starts the test
+// over, so it belongs at the top of the test body.
+#define USE_FIXTURE(title) attest_use_fixture(&title##_fixture)
+
 #define BEFORE_ALL(context)                                                   \
     static void attest_before_all(GlobalContext*(context));                   \
     static void __attribute__((constructor)) register_attest_before_all(void) \
@@ -1032,24 +7618,33 @@ bool every_instance(Status status)
         parameterize_before_all_cases = cfg.before_all_cases;                \
         parameterize_after_all_cases = cfg.after_all_cases;                  \
     }                                                                        \
+    char* title##_case_name(int case_index)                                  \
+    {                                                                        \
+        return title##_data[case_index].name;                                \
+    }                                                                        \
+    void title##_run_case(int slot, int case_index)                          \
+    {                                                                        \
+        TestConfig param_cfg = {                                             \
+            .filename = __FILE__,                                            \
+            .line = __LINE__,                                                \
+            .test_title = #title,                                            \
+            .param_test = title##_impl_wrapper,                              \
+            .param_index = slot,                                             \
+            .case_index = case_index,                                        \
+            __VA_ARGS__                                                      \
+        };                                                                   \
+        struct title##_type* test_case = &title##_data[case_index];          \
+        global_param_context.case_data = (void*)&test_case->data;            \
+        global_param_context.case_name = test_case->name;                    \
+        attest_internal_current_test = &param_cfg;                           \
+        attester();                                                          \
+        attest_internal_current_test = NULL;                                 \
+    }                                                                        \
     void title##_runner(void)                                                \
     {                                                                        \
-        for (int i = 0; i < case_count; i++) {                               \
-            TestConfig param_cfg = {                                         \
-                .filename = __FILE__,                                        \
-                .line = __LINE__,                                            \
-                .test_title = #title,                                        \
-                .param_test = title##_impl_wrapper,                          \
-                .param_index = i,                                            \
-                __VA_ARGS__                                                  \
-            };                                                               \
-            struct title##_type* test_case = &title##_data[i];               \
-            global_param_context.case_data = (void*)&test_case->data;        \
-            global_param_context.case_name = test_case->name;                \
-            attest_internal_current_test = &param_cfg;                       \
-            attester();                                                      \
-            attest_internal_current_test = NULL;                             \
-        }                                                                    \
+        TestConfig cfg = { __VA_ARGS__ };                                    \
+        attest_run_cases(                                                    \
+            #title, __FILE__, &cfg, title##_case_name, title##_run_case);    \
     }                                                                        \
     static void __attribute__((constructor)) register_##title##_runner(void) \
     {                                                                        \
@@ -1064,7 +7659,7 @@ bool every_instance(Status status)
     }                                                                        \
     void title##_impl_wrapper(TestConfig* cfg)                               \
     {                                                                        \
-        title##_impl(title##_data[cfg->param_index].data);                   \
+        title##_impl(title##_data[cfg->case_index].data);                   \
     }                                                                        \
     void title##_impl(param_type param_var)
 
@@ -1087,24 +7682,33 @@ bool every_instance(Status status)
         parameterize_before_all_cases = cfg.before_all_cases;                     \
         parameterize_after_all_cases = cfg.after_all_cases;                       \
     }                                                                             \
+    char* title##_case_name(int case_index)                                       \
+    {                                                                             \
+        return title##_data[case_index].name;                                     \
+    }                                                                             \
+    void title##_run_case(int slot, int case_index)                               \
+    {                                                                             \
+        TestConfig param_cfg = {                                                  \
+            .filename = __FILE__,                                                 \
+            .line = __LINE__,                                                     \
+            .test_title = #title,                                                 \
+            .param_test = title##_impl_wrapper,                                   \
+            .param_index = slot,                                                  \
+            .case_index = case_index,                                             \
+            __VA_ARGS__                                                           \
+        };                                                                        \
+        struct title##_type* test_case = &title##_data[case_index];               \
+        global_param_context.case_data = (void*)&test_case->data;                 \
+        global_param_context.case_name = test_case->name;                         \
+        attest_internal_current_test = &param_cfg;                                \
+        attester();                                                               \
+        attest_internal_current_test = NULL;                                      \
+    }                                                                             \
     void title##_runner(void)                                                     \
     {                                                                             \
-        for (int i = 0; i < case_count; i++) {                                    \
-            TestConfig param_cfg = {                                              \
-                .filename = __FILE__,                                             \
-                .line = __LINE__,                                                 \
-                .test_title = #title,                                             \
-                .param_test = title##_impl_wrapper,                               \
-                .param_index = i,                                                 \
-                __VA_ARGS__                                                       \
-            };                                                                    \
-            struct title##_type* test_case = &title##_data[i];                    \
-            global_param_context.case_data = (void*)&test_case->data;             \
-            global_param_context.case_name = test_case->name;                     \
-            attest_internal_current_test = &param_cfg;                            \
-            attester();                                                           \
-            attest_internal_current_test = NULL;                                  \
-        }                                                                         \
+        TestConfig cfg = { __VA_ARGS__ };                                         \
+        attest_run_cases(                                                         \
+            #title, __FILE__, &cfg, title##_case_name, title##_run_case);         \
     }                                                                             \
     static void __attribute__((constructor)) register_##title##_runner(void)      \
     {                                                                             \
@@ -1120,16 +7724,163 @@ bool every_instance(Status status)
     void title##_impl_wrapper(TestConfig* cfg)                                    \
     {                                                                             \
         /* TODO: pass a copy of global_param_context */                           \
-        title##_impl(&global_param_context, title##_data[cfg->param_index].data); \
+        title##_impl(&global_param_context, title##_data[cfg->case_index].data); \
+    }                                                                             \
+    void title##_impl(ParamContext* context, param_type param_var)
+
+// Takes the cases from `provider`, a `bool (int case_index,
+// param_type* data, char* name)` that fills case `case_index` and
+// returns false once the cases run out. `name` has room for
+// `ATTEST_CASE_NAME_SIZE` bytes.
+#define PARAM_TEST_STREAM(title, param_type, param_var, provider, ...)            \
+    void title##_impl(param_type param_var);                                      \
+    void title##_impl_wrapper(TestConfig* cfg);                                   \
+    struct title##_type {                                                         \
+        char name[ATTEST_CASE_NAME_SIZE];                                         \
+        param_type data;                                                          \
+    };                                                                            \
+    static struct title##_type title##_current;                                   \
+                                                                                  \
+    void title##_init(void)                                                       \
+    {                                                                             \
+        TestConfig cfg = { __VA_ARGS__ };                                         \
+        case_count = 0;                                                           \
+        parameterize_before_all_cases = cfg.before_all_cases;                     \
+        parameterize_after_all_cases = cfg.after_all_cases;                       \
+    }                                                                             \
+    bool title##_next_case(int case_index)                                        \
+    {                                                                             \
+        title##_current.name[0] = '\0';                                           \
+        return provider(case_index, &title##_current.data, title##_current.name); \
     }                                                                             \
+    char* title##_case_name(int case_index)                                       \
+    {                                                                             \
+        (void)case_index;                                                         \
+        return title##_current.name;                                              \
+    }                                                                             \
+    void title##_run_case(int slot, int case_index)                               \
+    {                                                                             \
+        TestConfig param_cfg = {                                                  \
+            .filename = __FILE__,                                                 \
+            .line = __LINE__,                                                     \
+            .test_title = #title,                                                 \
+            .param_test = title##_impl_wrapper,                                   \
+            .param_index = slot,                                                  \
+            .case_index = case_index,                                             \
+            __VA_ARGS__                                                           \
+        };                                                                        \
+        global_param_context.case_data = (void*)&title##_current.data;            \
+        global_param_context.case_name = title##_current.name;                    \
+        attest_internal_current_test = &param_cfg;                                \
+        attester();                                                               \
+        attest_internal_current_test = NULL;                                      \
+    }                                                                             \
+    void title##_runner(void)                                                     \
+    {                                                                             \
+        TestConfig cfg = {                                                        \
+            .filename = __FILE__,                                                 \
+            .line = __LINE__,                                                     \
+            .test_title = #title,                                                 \
+            __VA_ARGS__                                                           \
+        };                                                                        \
+        attest_stream_cases(                                                      \
+            &cfg, title##_next_case, title##_case_name, title##_run_case);        \
+    }                                                                             \
+    static void __attribute__((constructor)) register_##title##_runner(void)      \
+    {                                                                             \
+        static TestConfig test_config = {                                         \
+            .filename = __FILE__,                                                 \
+            .line = __LINE__,                                                     \
+            .test_title = #title,                                                 \
+            .param_test_runner = title##_runner,                                  \
+            .param_init = title##_init,                                           \
+            .streams_cases = true,                                                \
+        };                                                                        \
+        attest_update_registry(&test_config);                                     \
+    }                                                                             \
+    void title##_impl_wrapper(TestConfig* cfg)                                    \
+    {                                                                             \
+        (void)cfg;                                                                \
+        title##_impl(title##_current.data);                                       \
+    }                                                                             \
+    void title##_impl(param_type param_var)
+
+#define PARAM_TEST_STREAM_CTX(title, context, param_type, param_var, provider, ...) \
+    void title##_impl(ParamContext* context, param_type param_var);                 \
+    void title##_impl_wrapper(TestConfig* cfg);                                     \
+    struct title##_type {                                                           \
+        char name[ATTEST_CASE_NAME_SIZE];                                           \
+        param_type data;                                                            \
+    };                                                                              \
+    static struct title##_type title##_current;                                     \
+                                                                                    \
+    void title##_init(void)                                                         \
+    {                                                                               \
+        TestConfig cfg = { __VA_ARGS__ };                                           \
+        case_count = 0;                                                             \
+        parameterize_before_all_cases = cfg.before_all_cases;                       \
+        parameterize_after_all_cases = cfg.after_all_cases;                         \
+    }                                                                               \
+    bool title##_next_case(int case_index)                                          \
+    {                                                                               \
+        title##_current.name[0] = '\0';                                             \
+        return provider(case_index, &title##_current.data, title##_current.name);   \
+    }                                                                               \
+    char* title##_case_name(int case_index)                                         \
+    {                                                                               \
+        (void)case_index;                                                           \
+        return title##_current.name;                                                \
+    }                                                                               \
+    void title##_run_case(int slot, int case_index)                                 \
+    {                                                                               \
+        TestConfig param_cfg = {                                                    \
+            .filename = __FILE__,                                                   \
+            .line = __LINE__,                                                       \
+            .test_title = #title,                                                   \
+            .param_test = title##_impl_wrapper,                                     \
+            .param_index = slot,                                                    \
+            .case_index = case_index,                                               \
+            __VA_ARGS__                                                             \
+        };                                                                          \
+        global_param_context.case_data = (void*)&title##_current.data;              \
+        global_param_context.case_name = title##_current.name;                      \
+        attest_internal_current_test = &param_cfg;                                  \
+        attester();                                                                 \
+        attest_internal_current_test = NULL;                                        \
+    }                                                                               \
+    void title##_runner(void)                                                       \
+    {                                                                               \
+        TestConfig cfg = {                                                          \
+            .filename = __FILE__,                                                   \
+            .line = __LINE__,                                                       \
+            .test_title = #title,                                                   \
+            __VA_ARGS__                                                             \
+        };                                                                          \
+        attest_stream_cases(                                                        \
+            &cfg, title##_next_case, title##_case_name, title##_run_case);          \
+    }                                                                               \
+    static void __attribute__((constructor)) register_##title##_runner(void)        \
+    {                                                                               \
+        static TestConfig test_config = {                                           \
+            .filename = __FILE__,                                                   \
+            .line = __LINE__,                                                       \
+            .test_title = #title,                                                   \
+            .param_test_runner = title##_runner,                                    \
+            .param_init = title##_init,                                             \
+            .streams_cases = true,                                                  \
+        };                                                                          \
+        attest_update_registry(&test_config);                                       \
+    }                                                                               \
+    void title##_impl_wrapper(TestConfig* cfg)                                      \
+    {                                                                               \
+        (void)cfg;                                                                  \
+        title##_impl(&global_param_context, title##_current.data);                  \
+    }                                                                               \
     void title##_impl(ParamContext* context, param_type param_var)
 
 /**************************
  * EXPECTATIONS
  *************************/
-// TODO: We are voiding the return values of `sn?printf` to silence
-// the warning from clang-tidy check `cert-err3-c`. Decide if it is
-// worth the increase in macro compelxity to properly handle result.
 #define PICK_ONE_FOR_CONDITION(x, ...) x
 
 #define COUNT_ARG(                          \
@@ -1151,367 +7902,251 @@ bool every_instance(Status status)
 #define MSG_DISPATCH_FOR_TWO_ARGS(...) \
     EXPECT_DISPATCH(TAKE_ONE(__VA_ARGS__))(TAKE_TWO(__VA_ARGS__))
 
-#define IGNORE_MESSAGE(...)
-
-#define SAVE_MESSAGE(...)                                   \
-    int msg_size = snprintf(NULL, 0, __VA_ARGS__);          \
-    if (msg_size > 0) {                                     \
-        failure_info.has_msg = true;                        \
-        if (msg_size < ATTEST_VALUE_BUF) {                  \
-            (void)snprintf(                                 \
-                failure_info.msg,                           \
-                ATTEST_VALUE_BUF,                           \
-                __VA_ARGS__);                               \
-        } else {                                            \
-            (void)sprintf(failure_info.msg, "(truncated)"); \
-        }                                                   \
-    } else if (msg_size < 0) {                              \
-        failure_info.has_msg = true;                        \
-        (void)sprintf(failure_info.msg,                     \
-            "[ERROR] Unable to format message");            \
-    }
+#define MSG_DISPATCH_FOR_THREE_ARGS(...) \
+    EXPECT_DISPATCH(TAKE_TWO(__VA_ARGS__))(TAKE_THREE(__VA_ARGS__))
+
+#define MSG_DISPATCH_FOR_FOUR_ARGS(...) \
+    EXPECT_DISPATCH(TAKE_THREE(__VA_ARGS__))(TAKE_FOUR(__VA_ARGS__))
+
+// The message becomes the trailing arguments of the failure call, or
+// NULL without one.
+#define IGNORE_MESSAGE(...) NULL
+
+#define SAVE_MESSAGE(...) __VA_ARGS__
 
 #define TAKE_ONE(x, ...) __VA_ARGS__
 #define TAKE_TWO(x, y, ...) __VA_ARGS__
+#define TAKE_THREE(x, y, z, ...) __VA_ARGS__
+#define TAKE_FOUR(x, y, z, w, ...) __VA_ARGS__
 
-#define BUILD_RELATION_REASON(relation, x, y, ...) \
-    "[ %s %s %s ]", #x, #relation, #y
+#define UNGROUP(...) __VA_ARGS__
 
-#define BUILD_CONDITION_REASON(type, x, ...) \
-    "[ %s ] should be %s", #x, #type
+// Operands are evaluated once into locals of their own type, so the
+// compare keeps the conversions of C and the failure shows the values
+// that were compared.
+#define ATTEST_OPERAND(x) __typeof__(1 ? (x) : (x))
+#define ATTEST_PTR_OPERAND(x) const void*
+#define ATTEST_STRING_OPERAND(x) const char*
+
+// Labels and the verification are a string literal of the call site,
+// so a failing expectation is a single call to one of the
+// `attest_fail_*` functions.
+#define ATTEST_SITE(verification, actual_label, expected_label, reason) \
+    __FILE__ "\0" verification "\0" actual_label "\0" expected_label "\0" reason
+
+#define EXPECT_CONDITION(condition, verification, reason, message, x, ...) \
+    ATTEST_EXPECT(                                                         \
+        (void)0,                                                           \
+        condition,                                                         \
+        attest_fail_int(ATTEST_SITE(#verification, #x, "", reason), __LINE__, 0, 0, UNGROUP message))
+
+#define EXPECT_ONE_VALUE(operand, condition, fail, cast, verification, reason, message, x, ...) \
+    ATTEST_EXPECT(                                                                             \
+        operand(x) attest_actual = (x),                                                        \
+        condition,                                                                             \
+        fail(ATTEST_SITE(#verification, #x, "", reason), __LINE__, cast attest_actual, 0, UNGROUP message))
+
+#define EXPECT_TWO_VALUES(operand, condition, fail, cast, verification, message, x, y, ...) \
+    ATTEST_EXPECT(                                                                         \
+        operand(x) attest_actual = (x);                                                    \
+        operand(y) attest_expected = (y),                                                  \
+        condition,                                                                         \
+        fail(ATTEST_SITE(#verification, #x, #y, ""), __LINE__, cast attest_actual, cast attest_expected, UNGROUP message))
+
+#define EXPECT_DIFF_BYTES(verification, message, x, y, size, ...)                   \
+    ATTEST_EXPECT(                                                                  \
+        const void* attest_actual = (x);                                            \
+        const void* attest_expected = (y);                                          \
+        size_t attest_size = (size),                                                \
+        memcmp(attest_actual, attest_expected, attest_size) != 0,                   \
+        attest_fail_ptr(ATTEST_SITE(#verification, #x, #y, ""), __LINE__, attest_actual, attest_expected, UNGROUP message))
+
+// The compare is a single memcmp, which libc vectorizes. Finding where
+// the buffers differ waits for the failure.
+#define EXPECT_SAME_BYTES(element_size, verification, message, x, y, count, ...)       \
+    ATTEST_EXPECT(                                                                   \
+        const void* attest_actual = (x);                                             \
+        const void* attest_expected = (y);                                           \
+        size_t attest_size = (size_t)(count) * element_size(x),                      \
+        memcmp(attest_actual, attest_expected, attest_size) == 0,                    \
+        attest_fail_memory(ATTEST_SITE(#verification, #x, #y, ""), __LINE__,         \
+            attest_actual, attest_expected, attest_size, element_size(x), UNGROUP message))
+
+#define ATTEST_BYTE_SIZE(x) (size_t)1
+#define ATTEST_ELEMENT_SIZE(x) sizeof(*(x))
+
+// Fails to compile when the elements of `x` and `y` differ in size, and
+// is the size otherwise.
+#define ATTEST_SAME_ELEMENT_SIZE(x, y) (sizeof(char[sizeof(*(x)) == sizeof(*(y)) ? 1 : -1]) * sizeof(*(x)))
+
+// Arrays of `float` or `double`. Other element types fail to compile.
+#define EXPECT_NEAR_ELEMENTS(message, x, y, count, tolerance, ...)                         \
+    ATTEST_EXPECT(                                                                       \
+        const void* attest_actual = (x);                                                 \
+        const void* attest_expected = (y);                                               \
+        size_t attest_element_size = ATTEST_SAME_ELEMENT_SIZE(x, y);                     \
+        size_t attest_count = (size_t)(count);                                           \
+        double attest_tolerance = (double)(tolerance);                                   \
+        size_t attest_index = _Generic(*(x),                                             \
+            float: attest_first_far_float,                                               \
+            double: attest_first_far_double)(attest_actual, attest_expected, attest_count, attest_tolerance), \
+        attest_index == attest_count,                                                    \
+        attest_fail_near(ATTEST_SITE("EXPECT_NEAR_ARRAY", #x, #y, ""), __LINE__,          \
+            attest_actual, attest_expected, attest_count, attest_element_size, attest_index, UNGROUP message))
+
+#define EXPECT_RELATION(operator, fail, cast, verification, ...) \
+    EXPECT_TWO_VALUES(ATTEST_OPERAND,                             \
+        attest_actual operator attest_expected,                   \
+        fail, cast, verification,                                 \
+        (MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT(...)                                    \
+    EXPECT_CONDITION(PICK_ONE_FOR_CONDITION(__VA_ARGS__), \
+        EXPECT, "Condition must be TRUE",              \
+        (MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_FALSE(...)                                     \
+    EXPECT_ONE_VALUE(ATTEST_OPERAND, !attest_actual,          \
+        attest_fail_int, (long long), EXPECT_FALSE,           \
+        "Condition must be FALSE",                            \
+        (MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_EQ(...) EXPECT_RELATION(==, attest_fail_int, (long long), EXPECT_EQ, __VA_ARGS__)
+
+#define EXPECT_EQ_U(...) EXPECT_RELATION(==, attest_fail_uint, (unsigned long long), EXPECT_EQ, __VA_ARGS__)
+
+#define EXPECT_NEQ(...) EXPECT_RELATION(!=, attest_fail_int, (long long), EXPECT_NEQ, __VA_ARGS__)
+
+#define EXPECT_NEQ_U(...) EXPECT_RELATION(!=, attest_fail_uint, (unsigned long long), EXPECT_NEQ, __VA_ARGS__)
+
+#define EXPECT_GT(...) EXPECT_RELATION(>, attest_fail_int, (long long), EXPECT_GT, __VA_ARGS__)
+
+#define EXPECT_GT_U(...) EXPECT_RELATION(>, attest_fail_uint, (unsigned long long), EXPECT_GT, __VA_ARGS__)
+
+#define EXPECT_GTE(...) EXPECT_RELATION(>=, attest_fail_int, (long long), EXPECT_GTE, __VA_ARGS__)
+
+#define EXPECT_GTE_U(...) EXPECT_RELATION(>=, attest_fail_uint, (unsigned long long), EXPECT_GTE, __VA_ARGS__)
+
+#define EXPECT_LT(...) EXPECT_RELATION(<, attest_fail_int, (long long), EXPECT_LT, __VA_ARGS__)
+
+#define EXPECT_LT_U(...) EXPECT_RELATION(<, attest_fail_uint, (unsigned long long), EXPECT_LT, __VA_ARGS__)
+
+#define EXPECT_LTE(...) EXPECT_RELATION(<=, attest_fail_int, (long long), EXPECT_LTE, __VA_ARGS__)
+
+#define EXPECT_LTE_U(...) EXPECT_RELATION(<=, attest_fail_uint, (unsigned long long), EXPECT_LTE, __VA_ARGS__)
+
+#define EXPECT_SAME_STRING(...)                                        \
+    EXPECT_TWO_VALUES(ATTEST_STRING_OPERAND,                           \
+        strcmp(attest_actual, attest_expected) == 0,                   \
+        attest_fail_string, (const char*), EXPECT_SAME_STRING,         \
+        (MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_DIFF_STRING(...)                                        \
+    EXPECT_TWO_VALUES(ATTEST_STRING_OPERAND,                           \
+        strcmp(attest_actual, attest_expected) != 0,                   \
+        attest_fail_string, (const char*), EXPECT_DIFF_STRING,         \
+        (MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_SAME_CHAR(...) EXPECT_RELATION(==, attest_fail_char, (int), EXPECT_SAME_CHAR, __VA_ARGS__)
+
+#define EXPECT_DIFF_CHAR(...) EXPECT_RELATION(!=, attest_fail_char, (int), EXPECT_DIFF_CHAR, __VA_ARGS__)
+
+#define EXPECT_NULL(...)                                      \
+    EXPECT_ONE_VALUE(ATTEST_PTR_OPERAND, attest_actual == NULL, \
+        attest_fail_ptr, (const void*), EXPECT_NULL,          \
+        "Pointer must be NULL",                               \
+        (MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_NOT_NULL(...)                                  \
+    EXPECT_ONE_VALUE(ATTEST_PTR_OPERAND, attest_actual != NULL, \
+        attest_fail_ptr, (const void*), EXPECT_NOT_NULL,      \
+        "Pointer must not be NULL",                           \
+        (MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_SAME_PTR(...)                                  \
+    EXPECT_TWO_VALUES(ATTEST_PTR_OPERAND,                     \
+        attest_actual == attest_expected,                     \
+        attest_fail_ptr, (const void*), EXPECT_SAME_PTR,      \
+        (MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_DIFF_PTR(...)                                  \
+    EXPECT_TWO_VALUES(ATTEST_PTR_OPERAND,                     \
+        attest_actual != attest_expected,                     \
+        attest_fail_ptr, (const void*), EXPECT_DIFF_PTR,      \
+        (MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_SAME_MEMORY(...)                     \
+    EXPECT_SAME_BYTES(ATTEST_BYTE_SIZE, EXPECT_SAME_MEM, \
+        (MSG_DISPATCH_FOR_THREE_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_DIFF_MEMORY(...)    \
+    EXPECT_DIFF_BYTES(EXPECT_DIFF_MEM, (MSG_DISPATCH_FOR_THREE_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_SAME_ARRAY(...)                           \
+    EXPECT_SAME_BYTES(ATTEST_ELEMENT_SIZE, EXPECT_SAME_ARRAY, \
+        (MSG_DISPATCH_FOR_THREE_ARGS(__VA_ARGS__)), __VA_ARGS__)
+
+#define EXPECT_NEAR_ARRAY(...) \
+    EXPECT_NEAR_ELEMENTS((MSG_DISPATCH_FOR_FOUR_ARGS(__VA_ARGS__)), __VA_ARGS__)
 
-#define BUILD_RELATION(operator, x, y, ...) x operator y
+#ifdef ATTEST_TRACK_ALLOCS
+// Block forms. `break` or `return` inside the block skip the check.
+#define EXPECT_MAX_ALLOCS(limit)                                                  \
+    for (AllocScope attest_alloc_scope = attest_begin_alloc_scope(                \
+             __FILE__, __LINE__, "EXPECT_MAX_ALLOCS",                             \
+             "Block must allocate at most " #limit " times",                      \
+             #limit, (long long)(limit));                                         \
+         attest_alloc_scope.active;                                               \
+         attest_end_alloc_scope(&attest_alloc_scope))
 
-#define UNGROUP(...) __VA_ARGS__
+#define EXPECT_NO_ALLOC                                                \
+    for (AllocScope attest_alloc_scope = attest_begin_alloc_scope(     \
+             __FILE__, __LINE__, "EXPECT_NO_ALLOC",                    \
+             "Block must not allocate", NULL, 0);                      \
+         attest_alloc_scope.active;                                    \
+         attest_end_alloc_scope(&attest_alloc_scope))
+#else
+#define EXPECT_MAX_ALLOCS(limit) define_ATTEST_TRACK_ALLOCS_to_use_EXPECT_MAX_ALLOCS
+#define EXPECT_NO_ALLOC define_ATTEST_TRACK_ALLOCS_to_use_EXPECT_NO_ALLOC
+#endif
 
-#define COLLECT_ONE_VERIFICATION_TOKEN(verification, x, ...) \
-    int verification_token_size = snprintf(                  \
-        NULL,                                                \
-        0,                                                   \
-        "%s(%s)",                                            \
-        #verification, #x);                                  \
-    if (verification_token_size > 0) {                       \
-        if (verification_token_size < ATTEST_VALUE_BUF) {    \
-            (void)snprintf(failure_info.verification_text,   \
-                ATTEST_VALUE_BUF,                            \
-                "%s(%s)",                                    \
-                #verification, #x);                          \
-        } else {                                             \
-            (void)snprintf(failure_info.verification_text,   \
-                ATTEST_VALUE_BUF,                            \
-                "%s( truncated )",                           \
-                #verification);                              \
-        }                                                    \
-    }
-
-#define COLLECT_TWO_VERIFICATION_TOKENS(verification, x, y, ...) \
-    int verification_token_size = snprintf(                      \
-        NULL,                                                    \
-        0,                                                       \
-        "%s(%s, %s)",                                            \
-        #verification, #x, #y);                                  \
-    if (verification_token_size > 0) {                           \
-        if (verification_token_size < ATTEST_VALUE_BUF) {        \
-            (void)snprintf(failure_info.verification_text,       \
-                ATTEST_VALUE_BUF,                                \
-                "%s(%s, %s)",                                    \
-                #verification, #x, #y);                          \
-        } else {                                                 \
-            (void)snprintf(failure_info.verification_text,       \
-                ATTEST_VALUE_BUF,                                \
-                "%s( truncated )",                               \
-                #verification);                                  \
-        }                                                        \
-    }
+#ifdef ATTEST_PERF_COUNTERS
+// Block form. Counts the user space instructions of the calling thread.
+#define EXPECT_MAX_INSTRUCTIONS(limit)                                    \
+    for (PerfScope attest_perf_scope = attest_begin_perf_scope(           \
+             __FILE__, __LINE__, #limit, (long long)(limit));             \
+         attest_perf_scope.active;                                        \
+         attest_end_perf_scope(&attest_perf_scope))
+#else
+#define EXPECT_MAX_INSTRUCTIONS(limit) define_ATTEST_PERF_COUNTERS_to_use_EXPECT_MAX_INSTRUCTIONS
+#endif
+
+#define EXPECT_ELAPSED(message, x, budget, ...)                             \
+    ATTEST_EXPECT(                                                          \
+        long long attest_budget_ns = (long long)(budget),                   \
+        attest_elapsed_ns <= attest_budget_ns,                              \
+        attest_fail_ns(ATTEST_SITE("EXPECT_FASTER_THAN", #x, #budget, ""), __LINE__, attest_elapsed_ns, attest_budget_ns, UNGROUP message))
+
+// Evaluates the expression once and fails when it took longer than the
+// budget in nanoseconds of wall time.
+#define EXPECT_FASTER_THAN(...)                                              \
+    do {                                                                     \
+        long long attest_started_ns = attest_wall_now();                     \
+        (void)(PICK_ONE_FOR_CONDITION(__VA_ARGS__));                         \
+        long long attest_elapsed_ns = attest_wall_now() - attest_started_ns; \
+        EXPECT_ELAPSED((MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__)), __VA_ARGS__); \
+    } while (0)
 
-#define SAVE_ONE_VALUE(format, failure_reason, x, ...) \
-    failure_info.has_expected_value = false;           \
-    int actual_label_size = snprintf(                  \
-        NULL,                                          \
-        0,                                             \
-        "%s",                                          \
-        #x);                                           \
-    if (actual_label_size > 0) {                       \
-        if (actual_label_size < ATTEST_VALUE_BUF) {    \
-            (void)snprintf(failure_info.actual_label,  \
-                ATTEST_VALUE_BUF,                      \
-                "%s",                                  \
-                #x);                                   \
-        } else {                                       \
-            (void)sprintf(failure_info.actual_label,   \
-                "(truncated)");                        \
-        }                                              \
-    }                                                  \
-    int actual_value_size = snprintf(                  \
-        NULL,                                          \
-        0,                                             \
-        UNGROUP format(x));                            \
-    if (actual_value_size > 0) {                       \
-        if (actual_value_size < ATTEST_VALUE_BUF) {    \
-            (void)snprintf(failure_info.actual_value,  \
-                ATTEST_VALUE_BUF,                      \
-                UNGROUP format(x));                    \
-        } else {                                       \
-            (void)sprintf(failure_info.actual_value,   \
-                "(truncated)");                        \
-        }                                              \
-    }                                                  \
-    (void)snprintf(failure_info.reason,                \
-        ATTEST_VALUE_BUF,                              \
-        failure_reason);
-
-#define SAVE_TWO_VALUE(format, x, y, ...)               \
-    failure_info.has_expected_value = true;             \
-    int actual_label_size = snprintf(                   \
-        NULL,                                           \
-        0,                                              \
-        "%s",                                           \
-        #x);                                            \
-    if (actual_label_size > 0) {                        \
-        if (actual_label_size < ATTEST_VALUE_BUF) {     \
-            (void)snprintf(failure_info.actual_label,   \
-                ATTEST_VALUE_BUF,                       \
-                "%s",                                   \
-                #x);                                    \
-        } else {                                        \
-            (void)sprintf(failure_info.actual_label,    \
-                "(truncated)");                         \
-        }                                               \
-    }                                                   \
-    int actual_value_size = snprintf(                   \
-        NULL,                                           \
-        0,                                              \
-        UNGROUP format(x));                             \
-    if (actual_value_size > 0) {                        \
-        if (actual_value_size < ATTEST_VALUE_BUF) {     \
-            (void)snprintf(failure_info.actual_value,   \
-                ATTEST_VALUE_BUF,                       \
-                UNGROUP format(x));                     \
-        } else {                                        \
-            (void)sprintf(failure_info.actual_value,    \
-                "(truncated)");                         \
-        }                                               \
-    }                                                   \
-    int expected_label_size = snprintf(                 \
-        NULL,                                           \
-        0,                                              \
-        "%s",                                           \
-        #y);                                            \
-    if (expected_label_size > 0) {                      \
-        if (expected_label_size < ATTEST_VALUE_BUF) {   \
-            (void)snprintf(failure_info.expected_label, \
-                ATTEST_VALUE_BUF,                       \
-                "%s",                                   \
-                #y);                                    \
-        } else {                                        \
-            (void)sprintf(failure_info.expected_label,  \
-                "(truncated)");                         \
-        }                                               \
-    }                                                   \
-    int expected_value_size = snprintf(                 \
-        NULL,                                           \
-        0,                                              \
-        UNGROUP format(y));                             \
-    if (expected_value_size > 0) {                      \
-        if (actual_value_size < ATTEST_VALUE_BUF) {     \
-            (void)snprintf(failure_info.expected_value, \
-                ATTEST_VALUE_BUF,                       \
-                UNGROUP format(y));                     \
-        } else {                                        \
-            (void)sprintf(failure_info.expected_value,  \
-                "(truncated)");                         \
-        }                                               \
-    }
-
-#define EXPECT(...)                                          \
-    ATTEST_EXPECT(                                           \
-        PICK_ONE_FOR_CONDITION(__VA_ARGS__),                 \
-        MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__),               \
-        COLLECT_ONE_VERIFICATION_TOKEN(EXPECT, __VA_ARGS__), \
-        SAVE_ONE_VALUE(("%d", ), "Condition must be TRUE", __VA_ARGS__))
-
-#define EXPECT_FALSE(...)                                          \
-    ATTEST_EXPECT(                                                 \
-        !(PICK_ONE_FOR_CONDITION(__VA_ARGS__)),                    \
-        MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__),                     \
-        COLLECT_ONE_VERIFICATION_TOKEN(EXPECT_FALSE, __VA_ARGS__), \
-        SAVE_ONE_VALUE(("%d", ), "Condition must be FALSE", __VA_ARGS__))
-
-#define EXPECT_EQ(...)                                           \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(==, __VA_ARGS__),                         \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_EQ, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_EQ_U(...)                                         \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(==, __VA_ARGS__),                         \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_EQ, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define EXPECT_NEQ(...)                                           \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(!=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_NEQ, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_NEQ_U(...)                                         \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(!=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_NEQ, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define EXPECT_GT(...)                                           \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(>, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_GT, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_GT_U(...)                                         \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(>, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_GT, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define EXPECT_GTE(...)                                           \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(>=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_GTE, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_GTE_U(...)                                         \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(>=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_GTE, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define EXPECT_LT(...)                                           \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(<, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_LT, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_LT_U(...)                                         \
-    ATTEST_EXPECT(                                               \
-        BUILD_RELATION(<, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                  \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_LT, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define EXPECT_LTE(...)                                           \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(<=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_LTE, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%lld", (long long int)), __VA_ARGS__))
-
-#define EXPECT_LTE_U(...)                                         \
-    ATTEST_EXPECT(                                                \
-        BUILD_RELATION(<=, __VA_ARGS__),                          \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                   \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_LTE, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%llu", (unsigned long long int)), __VA_ARGS__))
-
-#define COMPARE_STRINGS(a, b) strcmp(a, b) == 0
-
-#define EXPECT_SAME_STRING(...)                                           \
-    ATTEST_EXPECT(                                                        \
-        COMPARE_STRINGS(__VA_ARGS__),                                     \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                           \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_SAME_STRING, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%s", ), __VA_ARGS__))
-
-#define EXPECT_DIFF_STRING(...)                                           \
-    ATTEST_EXPECT(                                                        \
-        !(COMPARE_STRINGS(__VA_ARGS__)),                                  \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                           \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_DIFF_STRING, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%s", ), __VA_ARGS__))
-
-#define EXPECT_SAME_CHAR(...)                                           \
-    ATTEST_EXPECT(                                                      \
-        BUILD_RELATION(==, __VA_ARGS__),                                \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                         \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_SAME_CHAR, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%c", ), __VA_ARGS__))
-
-#define EXPECT_DIFF_CHAR(...)                                           \
-    ATTEST_EXPECT(                                                      \
-        !(BUILD_RELATION(==, __VA_ARGS__)),                             \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                         \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_DIFF_CHAR, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%c", ), __VA_ARGS__))
-
-#define IS_NULL(ptr, ...) ptr == NULL
-
-#define EXPECT_NULL(...)                                          \
-    ATTEST_EXPECT(                                                \
-        IS_NULL(__VA_ARGS__),                                     \
-        MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__),                    \
-        COLLECT_ONE_VERIFICATION_TOKEN(EXPECT_NULL, __VA_ARGS__), \
-        SAVE_ONE_VALUE(("%p", (void*)), "Pointer must be NULL", __VA_ARGS__))
-
-#define EXPECT_NOT_NULL(...)                                          \
-    ATTEST_EXPECT(                                                    \
-        !(IS_NULL(__VA_ARGS__)),                                      \
-        MSG_DISPATCH_FOR_ONE_ARG(__VA_ARGS__),                        \
-        COLLECT_ONE_VERIFICATION_TOKEN(EXPECT_NOT_NULL, __VA_ARGS__), \
-        SAVE_ONE_VALUE(("%p", (void*)), "Pointer must not be NULL", __VA_ARGS__))
-
-#define EXPECT_SAME_PTR(...)                                           \
-    ATTEST_EXPECT(                                                     \
-        BUILD_RELATION(==, __VA_ARGS__),                               \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                        \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_SAME_PTR, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%p", (void*)), __VA_ARGS__))
-
-#define EXPECT_DIFF_PTR(...)                                           \
-    ATTEST_EXPECT(                                                     \
-        !(BUILD_RELATION(==, __VA_ARGS__)),                            \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                        \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_DIFF_PTR, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%p", (void*)), __VA_ARGS__))
-
-#define SAME_MEMORY(ptr_a, ptr_b, size, ...) memcmp(ptr_a, ptr_b, size) == 0
-
-#define EXPECT_SAME_MEMORY(...)                                        \
-    ATTEST_EXPECT(                                                     \
-        SAME_MEMORY(__VA_ARGS__),                                      \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                        \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_SAME_MEM, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%p", (void*)), __VA_ARGS__))
-
-#define EXPECT_DIFF_MEMORY(...)                                        \
-    ATTEST_EXPECT(                                                     \
-        !(SAME_MEMORY(__VA_ARGS__)),                                   \
-        MSG_DISPATCH_FOR_TWO_ARGS(__VA_ARGS__),                        \
-        COLLECT_TWO_VERIFICATION_TOKENS(EXPECT_DIFF_MEM, __VA_ARGS__), \
-        SAVE_TWO_VALUE(("%p", (void*)), __VA_ARGS__))
-
-#define ATTEST_EXPECT(condition, save_msg, save_verification, save_values) \
-    do {                                                                   \
-        if (condition) {                                                   \
-            report_success();                                              \
-            break;                                                         \
-        }                                                                  \
-        FailureInfo failure_info = {                                       \
-            .filename = __FILE__,                                          \
-            .line = __LINE__,                                              \
-            .has_msg = false,                                              \
-        };                                                                 \
-        save_msg;                                                          \
-        save_verification;                                                 \
-        save_values;                                                       \
-        report_failure(failure_info);                                      \
+#define ATTEST_EXPECT(operands, condition, fail)                 \
+    do {                                                         \
+        operands;                                                \
+        if (ATTEST_LIKELY(condition)) {                          \
+            if (ATTEST_UNLIKELY(attest_first_success_pending)) { \
+                report_success();                                \
+            }                                                    \
+            break;                                               \
+        }                                                        \
+        fail;                                                    \
     } while (0)
 
 /**********************************************
@@ -1521,6 +8156,26 @@ bool every_instance(Status status)
 
 #define test_ctx(...) TEST_CTX(__VA_ARGS__)
 
+#define bench(...) BENCH(__VA_ARGS__)
+
+#define bench_ctx(...) BENCH_CTX(__VA_ARGS__)
+
+#define do_not_optimize(...) DO_NOT_OPTIMIZE(__VA_ARGS__)
+
+#define property_test(...) PROPERTY_TEST(__VA_ARGS__)
+
+#define gen_range(...) GEN_RANGE(__VA_ARGS__)
+
+#define gen_int() GEN_INT()
+
+#define gen_bytes(...) GEN_BYTES(__VA_ARGS__)
+
+#define gen_string(...) GEN_STRING(__VA_ARGS__)
+
+#define fixture(...) FIXTURE(__VA_ARGS__)
+
+#define use_fixture(...) USE_FIXTURE(__VA_ARGS__)
+
 #define before_all(...) BEFORE_ALL(__VA_ARGS__)
 
 #define before_each(...) BEFORE_EACH(__VA_ARGS__)
@@ -1533,6 +8188,10 @@ bool every_instance(Status status)
 
 #define param_test_ctx(...) PARAM_TEST_CTX(__VA_ARGS__)
 
+#define param_test_stream(...) PARAM_TEST_STREAM(__VA_ARGS__)
+
+#define param_test_stream_ctx(...) PARAM_TEST_STREAM_CTX(__VA_ARGS__)
+
 #define expect(...) EXPECT(__VA_ARGS__)
 
 #define expect_false(...) EXPECT_FALSE(__VA_ARGS__)
@@ -1580,3 +8239,15 @@ bool every_instance(Status status)
 #define expect_same_memory(...) EXPECT_SAME_MEMORY(__VA_ARGS__)
 
 #define expect_diff_memory(...) EXPECT_DIFF_MEMORY(__VA_ARGS__)
+
+#define expect_same_array(...) EXPECT_SAME_ARRAY(__VA_ARGS__)
+
+#define expect_near_array(...) EXPECT_NEAR_ARRAY(__VA_ARGS__)
+
+#define expect_faster_than(...) EXPECT_FASTER_THAN(__VA_ARGS__)
+
+#define expect_max_allocs(...) EXPECT_MAX_ALLOCS(__VA_ARGS__)
+
+#define expect_no_alloc EXPECT_NO_ALLOC
+
+#define expect_max_instructions(...) EXPECT_MAX_INSTRUCTIONS(__VA_ARGS__)